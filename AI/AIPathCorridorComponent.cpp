@@ -0,0 +1,212 @@
+#include "AIPathCorridorComponent.h"
+#include "../Helpers.h"
+
+//
+// AIPathCorridorComponent
+//
+
+UAIPathCorridorComponent::UAIPathCorridorComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+
+
+void UAIPathCorridorComponent::SetNetwork(AAIPathNetwork* pNetwork)
+{
+	m_pNetwork = pNetwork;
+	m_Path = FAIPath{};
+}
+
+
+
+/// <summary>
+/// Intended to be called when the agent reaches a node or drifted off its path.
+/// When the node is on the front of the path the passed nodes get removed, when it is next to the front
+/// the path gets reconnected with a small search, only otherwise the full path gets searched again.
+/// </summary>
+/// <param name="agentNode">Node index the agent is at now</param>
+/// <returns>If there is a valid path towards the goal</returns>
+bool UAIPathCorridorComponent::SetAgentNode(int32 agentNode)
+{
+	if (agentNode == m_AgentNode && IsPathValid())
+	{
+		return true;
+	}
+
+	m_AgentNode = agentNode;
+	ClearPathWhenNetworkIsGone();
+	if (m_GoalNode == -1)
+	{
+		return false;
+	}
+
+	return (m_Path.m_bIsValid && RepairFront(agentNode)) || Replan();
+}
+
+
+
+/// <summary>
+/// Intended to be called when the goal moved (chased target, moved cover point, ...).
+/// When the new goal is on the path the rest of the path gets removed, when it is next to the end
+/// the path gets extended with a small search, only otherwise the full path gets searched again.
+/// </summary>
+/// <param name="goalNode">Node index of the new goal</param>
+/// <returns>If there is a valid path towards the goal</returns>
+bool UAIPathCorridorComponent::SetGoalNode(int32 goalNode)
+{
+	if (goalNode == m_GoalNode && IsPathValid())
+	{
+		return true;
+	}
+
+	m_GoalNode = goalNode;
+	ClearPathWhenNetworkIsGone();
+	if (m_AgentNode == -1)
+	{
+		return false;
+	}
+
+	return (m_Path.m_bIsValid && RepairBack(goalNode)) || Replan();
+}
+
+
+
+bool UAIPathCorridorComponent::IsPathValid() const
+{
+	if (!IsValid(m_pNetwork) || !m_Path.m_bIsValid)
+	{
+		return false;
+	}
+
+	const TArray<int32>& path = m_Path.m_Path;
+	for (int32 i = 1; i < path.Num(); i++)
+	{
+		if (!m_pNetwork->HasConnection(path[i - 1], path[i]))
+		{
+			return false;
+		}
+	}
+	return path.Num() != 0;
+}
+
+
+
+FAIPath UAIPathCorridorComponent::GetPath() const
+{
+	return m_Path;
+}
+
+
+
+int32 UAIPathCorridorComponent::GetNextNode() const
+{
+	return (m_Path.m_bIsValid && m_Path.m_Path.Num() > 1) ? m_Path.m_Path[1] : -1;
+}
+
+
+
+// helper functions
+
+/// <summary>
+/// The network gets destroyed when its sublevel streams out, the path (node indexes of that network) cant be repaired anymore.
+/// </summary>
+void UAIPathCorridorComponent::ClearPathWhenNetworkIsGone()
+{
+	if (!IsValid(m_pNetwork))
+	{
+		m_Path = FAIPath{};
+	}
+}
+
+
+
+/// <summary>
+/// Makes the path start at agentNode by cutting off passed nodes or splicing a short path onto the front.
+/// </summary>
+/// <returns>If the path could be repaired locally</returns>
+bool UAIPathCorridorComponent::RepairFront(int32 agentNode)
+{
+	TArray<int32>& path = m_Path.m_Path;
+	const int32 window = FMath::Min(m_RepairWindow, path.Num());
+
+	// walked further along the path
+	const int32 indexOnPath = path.Find(agentNode);
+	if (indexOnPath != INDEX_NONE && indexOnPath < window)
+	{
+		path.RemoveAt(0, indexOnPath);
+		return IsPathValid();
+	}
+
+	// drifted off, reconnecting to the last node of the window by searching backwards from it.
+	// the shortest path towards that node is never more expensive than splicing onto an earlier window node and walking the path from there,
+	// so the agent keeps moving forward instead of being sent back to the node it just left
+	const FAIPath forwardSplice = m_pNetwork->FindLocalPath(path[window - 1], { agentNode }, m_MaxRepairExpansions, true, m_AgentProfile);
+	if (forwardSplice.m_bIsValid)
+	{
+		path.RemoveAt(0, window);
+		path.Insert(forwardSplice.m_Path, 0);
+		return IsPathValid();
+	}
+
+	// the last window node is out of reach of the expansion budget, reconnecting to the closest of the window nodes instead
+	const TArray<int32> frontNodes(path.GetData(), window);
+	const FAIPath splice = m_pNetwork->FindLocalPath(agentNode, frontNodes, m_MaxRepairExpansions, false, m_AgentProfile);
+	if (!splice.m_bIsValid)
+	{
+		return false;
+	}
+
+	// splice ends at the reached path node, so everything before and including that node gets replaced
+	path.RemoveAt(0, path.Find(splice.m_Path.Last()) + 1);
+	path.Insert(splice.m_Path, 0);
+	return IsPathValid();
+}
+
+
+
+/// <summary>
+/// Makes the path end at goalNode by cutting off the end or splicing a short path onto the back.
+/// </summary>
+/// <returns>If the path could be repaired locally</returns>
+bool UAIPathCorridorComponent::RepairBack(int32 goalNode)
+{
+	TArray<int32>& path = m_Path.m_Path;
+
+	// every part of a shortest path is a shortest path as well, so the goal being on the path just cuts off the rest
+	const int32 indexOnPath = path.Find(goalNode);
+	if (indexOnPath != INDEX_NONE)
+	{
+		path.SetNum(indexOnPath + 1);
+		return IsPathValid();
+	}
+
+	// searching backwards from the new goal towards one of the last nodes of the path
+	const int32 window = FMath::Min(m_RepairWindow, path.Num());
+	const TArray<int32> backNodes(path.GetData() + path.Num() - window, window);
+	const FAIPath splice = m_pNetwork->FindLocalPath(goalNode, backNodes, m_MaxRepairExpansions, true, m_AgentProfile);
+	if (!splice.m_bIsValid)
+	{
+		return false;
+	}
+
+	// splice starts at the reached path node, so everything from that node on gets replaced
+	path.SetNum(path.FindLast(splice.m_Path[0]));
+	path.Append(splice.m_Path);
+	return IsPathValid();
+}
+
+
+
+bool UAIPathCorridorComponent::Replan()
+{
+	if (!IsValid(m_pNetwork))
+	{
+		LOG_TEXT(Warning, TEXT("UAIPathCorridorComponent::Replan no network was set!"));
+		m_Path = FAIPath{};
+		return false;
+	}
+
+	m_Path = m_pNetwork->FindPath(m_AgentNode, m_GoalNode, EAIPathSearchMode::EARLY_EXIT, m_AgentProfile);
+	return m_Path.m_bIsValid;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "AIPathNetwork.h"
+#include "AIPathCorridorComponent.generated.h"
+
+/// <summary>
+/// Keeps the current path of an agent and repairs it locally when the agent or the goal only moved a little,
+/// instead of searching the whole network again. Repaired paths can be slightly longer than the shortest path,
+/// a full search only happens when a local repair is not possible.
+/// </summary>
+UCLASS( ClassGroup=(AI), meta=(BlueprintSpawnableComponent) )
+class SANKARI_API UAIPathCorridorComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:	
+	UAIPathCorridorComponent();
+
+	// amount of nodes at the front / back of the path a local repair tries to reconnect to
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathCorridor", Meta = (DisplayName = "Repair Window", ClampMin = "1"))
+		int32 m_RepairWindow = 4;
+
+	// amount of nodes a local repair can expand before falling back to a full search
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathCorridor", Meta = (DisplayName = "Max Repair Expansions", ClampMin = "1"))
+		int32 m_MaxRepairExpansions = 64;
+
+	// index in AAIPathNetwork::m_AgentProfiles used for all searches of this corridor
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathCorridor", Meta = (DisplayName = "Agent Profile", ClampMin = "0"))
+		int32 m_AgentProfile = 0;
+
+	UFUNCTION(BlueprintCallable, Category = "AIPathCorridor")
+		void SetNetwork(class AAIPathNetwork* pNetwork);
+
+	// moves the start of the corridor to the node the agent is at now, returns if there is a valid path
+	UFUNCTION(BlueprintCallable, Category = "AIPathCorridor")
+		bool SetAgentNode(int32 agentNode);
+
+	// moves the end of the corridor to a new goal node, returns if there is a valid path
+	UFUNCTION(BlueprintCallable, Category = "AIPathCorridor")
+		bool SetGoalNode(int32 goalNode);
+
+	// checks if every connection of the path still exists in the network
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "AIPathCorridor")
+		bool IsPathValid() const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "AIPathCorridor")
+		FAIPath GetPath() const;
+
+	// node after the one the agent is at, -1 when there is none
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "AIPathCorridor")
+		int32 GetNextNode() const;
+
+private:
+	void ClearPathWhenNetworkIsGone();
+	bool RepairFront(int32 agentNode);
+	bool RepairBack(int32 goalNode);
+	bool Replan();
+
+	UPROPERTY()
+		class AAIPathNetwork* m_pNetwork = nullptr;
+
+	// always starts at m_AgentNode and ends at m_GoalNode when valid
+	FAIPath m_Path;
+
+	int32 m_AgentNode = -1;
+	int32 m_GoalNode = -1;
+};
@@ -0,0 +1,969 @@
+#include "AIPathGraph.h"
+#include "Algo/Reverse.h"
+#include "Async/ParallelFor.h"
+
+//
+// AIPathGraph
+//
+
+void FAIPathGraph::Empty()
+{
+	m_EdgeOffsets.Empty();
+	m_EdgeTargets.Empty();
+	m_EdgeWeights.Empty();
+	m_EdgeLengths.Empty();
+	m_ReverseEdgeOffsets.Empty();
+	m_ReverseEdgeSources.Empty();
+	m_ReverseEdgeIndices.Empty();
+	m_RuntimeToAuthoring.Empty();
+	m_AuthoringToRuntime.Empty();
+}
+
+
+
+int32 FAIPathGraph::Num() const
+{
+	return FMath::Max(m_EdgeOffsets.Num() - 1, 0);
+}
+
+
+
+/// <summary>
+/// Builds the reverse edges with a counting sort on the edge targets.
+/// </summary>
+void FAIPathGraph::BuildReverseEdges()
+{
+	const int32 amountOfNodes = Num();
+	const int32 amountOfEdges = m_EdgeTargets.Num();
+
+	// counting incoming edges per node, shifted by one so the prefix sum gives the offsets
+	m_ReverseEdgeOffsets.Init(0, amountOfNodes + 1);
+	for (int32 target : m_EdgeTargets)
+	{
+		m_ReverseEdgeOffsets[target + 1]++;
+	}
+
+	for (int32 i = 0; i < amountOfNodes; i++)
+	{
+		m_ReverseEdgeOffsets[i + 1] += m_ReverseEdgeOffsets[i];
+	}
+
+	m_ReverseEdgeSources.SetNumUninitialized(amountOfEdges);
+	m_ReverseEdgeIndices.SetNumUninitialized(amountOfEdges);
+
+	TArray<int32> writeIndexes(m_ReverseEdgeOffsets.GetData(), amountOfNodes);
+	for (int32 source = 0; source < amountOfNodes; source++)
+	{
+		for (int32 edge = m_EdgeOffsets[source]; edge < m_EdgeOffsets[source + 1]; edge++)
+		{
+			const int32 writeIndex = writeIndexes[m_EdgeTargets[edge]]++;
+			m_ReverseEdgeSources[writeIndex] = source;
+			m_ReverseEdgeIndices[writeIndex] = edge;
+		}
+	}
+}
+
+
+
+/// <summary>
+/// Computes all edge weights in one pass over the node locations packed per axis.
+/// Graphs with enough edges get split in ranges of nodes that are handled by the worker threads.
+/// </summary>
+/// <param name="locations">Location of every node, in authoring order</param>
+void FAIPathGraph::ComputeSquaredDistanceWeights(const TArray<FVector>& locations)
+{
+	// below this amount of edges per task the threading costs more than it gains
+	constexpr int32 minEdgesPerTask = 16 * 1024;
+
+	const int32 amountOfNodes = Num();
+	const int32 amountOfEdges = m_EdgeTargets.Num();
+	check(locations.Num() == amountOfNodes);
+
+	TArray<float> locationsX{};
+	TArray<float> locationsY{};
+	TArray<float> locationsZ{};
+	locationsX.SetNumUninitialized(amountOfNodes);
+	locationsY.SetNumUninitialized(amountOfNodes);
+	locationsZ.SetNumUninitialized(amountOfNodes);
+	for (int32 i = 0; i < amountOfNodes; i++)
+	{
+		locationsX[i] = locations[i].X;
+		locationsY[i] = locations[i].Y;
+		locationsZ[i] = locations[i].Z;
+	}
+
+	m_EdgeWeights.SetNumUninitialized(amountOfEdges);
+	m_EdgeLengths.SetNumUninitialized(amountOfEdges);
+
+	const int32 amountOfTasks = FMath::Clamp(amountOfEdges / minEdgesPerTask, 1, FMath::Max(FPlatformMisc::NumberOfCoresIncludingHyperthreads(), 1));
+	const int32 nodesPerTask = FMath::DivideAndRoundUp(FMath::Max(amountOfNodes, 1), amountOfTasks);
+
+	// raw pointers so the inner loop has no bounds checks, tasks only write the weights of their own nodes
+	const int32* pOffsets = m_EdgeOffsets.GetData();
+	const int32* pTargets = m_EdgeTargets.GetData();
+	const float* pX = locationsX.GetData();
+	const float* pY = locationsY.GetData();
+	const float* pZ = locationsZ.GetData();
+	float* pWeights = m_EdgeWeights.GetData();
+	float* pLengths = m_EdgeLengths.GetData();
+
+	ParallelFor(amountOfTasks, [=](int32 task)
+	{
+		const int32 nodeEnd = FMath::Min((task + 1) * nodesPerTask, amountOfNodes);
+		for (int32 node = task * nodesPerTask; node < nodeEnd; node++)
+		{
+			const float x = pX[node];
+			const float y = pY[node];
+			const float z = pZ[node];
+
+			const int32 edgeEnd = pOffsets[node + 1];
+			for (int32 edge = pOffsets[node]; edge < edgeEnd; edge++)
+			{
+				const int32 target = pTargets[edge];
+				const float dx = pX[target] - x;
+				const float dy = pY[target] - y;
+				const float dz = pZ[target] - z;
+				pWeights[edge] = dx * dx + dy * dy + dz * dz;
+				pLengths[edge] = FMath::Sqrt(pWeights[edge]);
+			}
+		}
+	}, amountOfTasks == 1);
+}
+
+
+
+void FAIPathGraph::InitializeNodeOrder()
+{
+	const int32 amountOfNodes = Num();
+	m_RuntimeToAuthoring.SetNumUninitialized(amountOfNodes);
+	m_AuthoringToRuntime.SetNumUninitialized(amountOfNodes);
+	for (int32 i = 0; i < amountOfNodes; i++)
+	{
+		m_RuntimeToAuthoring[i] = i;
+		m_AuthoringToRuntime[i] = i;
+	}
+}
+
+
+
+/// <summary>
+/// Rebuilds all edges with the nodes at their new index and rebuilds the reverse edges after.
+/// Edges of a node keep their order so the weights stay the same.
+/// </summary>
+/// <param name="runtimeToAuthoring">Authoring index for every new runtime index, has to contain every node once</param>
+void FAIPathGraph::Reorder(const TArray<int32>& runtimeToAuthoring)
+{
+	const int32 amountOfNodes = Num();
+	check(runtimeToAuthoring.Num() == amountOfNodes);
+
+	m_RuntimeToAuthoring = runtimeToAuthoring;
+	m_AuthoringToRuntime.SetNumUninitialized(amountOfNodes);
+	for (int32 i = 0; i < amountOfNodes; i++)
+	{
+		m_AuthoringToRuntime[runtimeToAuthoring[i]] = i;
+	}
+
+	TArray<int32> edgeOffsets{};
+	TArray<int32> edgeTargets{};
+	TArray<float> edgeWeights{};
+	TArray<float> edgeLengths{};
+	edgeOffsets.Reserve(amountOfNodes + 1);
+	edgeTargets.Reserve(m_EdgeTargets.Num());
+	edgeWeights.Reserve(m_EdgeWeights.Num());
+	edgeLengths.Reserve(m_EdgeLengths.Num());
+
+	edgeOffsets.Add(0);
+	for (int32 runtimeNode = 0; runtimeNode < amountOfNodes; runtimeNode++)
+	{
+		const int32 authoringNode = m_RuntimeToAuthoring[runtimeNode];
+		for (int32 edge = m_EdgeOffsets[authoringNode]; edge < m_EdgeOffsets[authoringNode + 1]; edge++)
+		{
+			edgeTargets.Add(m_AuthoringToRuntime[m_EdgeTargets[edge]]);
+			edgeWeights.Add(m_EdgeWeights[edge]);
+			edgeLengths.Add(m_EdgeLengths[edge]);
+		}
+		edgeOffsets.Add(edgeTargets.Num());
+	}
+
+	m_EdgeOffsets = MoveTemp(edgeOffsets);
+	m_EdgeTargets = MoveTemp(edgeTargets);
+	m_EdgeWeights = MoveTemp(edgeWeights);
+	m_EdgeLengths = MoveTemp(edgeLengths);
+	BuildReverseEdges();
+}
+
+
+
+int32 FAIPathGraph::ToRuntime(int32 authoringNode) const
+{
+	return m_AuthoringToRuntime[authoringNode];
+}
+
+
+
+int32 FAIPathGraph::ToAuthoring(int32 runtimeNode) const
+{
+	return m_RuntimeToAuthoring[runtimeNode];
+}
+
+
+
+void FAIPathGraph::ToAuthoring(TArray<int32>& inOutNodes) const
+{
+	for (int32& node : inOutNodes)
+	{
+		node = m_RuntimeToAuthoring[node];
+	}
+}
+
+
+
+//
+// AIPathComponents
+//
+
+void FAIPathComponents::Empty()
+{
+	m_StrongLabels.Empty();
+	m_WeakLabels.Empty();
+	m_AmountOfStrongComponents = 0;
+	m_Reachability.Empty();
+	m_ReachabilityRowSize = 0;
+}
+
+
+
+/// <summary>
+/// Labels the strongly connected components with an iterative tarjan, the weakly connected components with a flood fill
+/// over both edge directions and when there arent too many strong components also stores which ones reach each other.
+/// O(nodes + edges) apart from the reachability table.
+/// </summary>
+/// <param name="graph">The graph to label, needs its reverse edges</param>
+void FAIPathComponents::Build(const FAIPathGraph& graph)
+{
+	Empty();
+	const int32 amountOfNodes = graph.Num();
+
+	// strongly connected components (tarjan without recursion)
+	m_StrongLabels.Init(-1, amountOfNodes);
+	TArray<int32> visitIndexes{};
+	visitIndexes.Init(-1, amountOfNodes);
+	TArray<int32> lowLinks{};
+	lowLinks.SetNumUninitialized(amountOfNodes);
+	TBitArray<> isOnStack(false, amountOfNodes);
+	TArray<int32> stack{};
+
+	// <node, next edge to visit>
+	TArray<TPair<int32, int32>> callStack{};
+	int32 nextVisitIndex = 0;
+
+	auto visit = [&](int32 nodeIndex)
+	{
+		visitIndexes[nodeIndex] = lowLinks[nodeIndex] = nextVisitIndex++;
+		stack.Push(nodeIndex);
+		isOnStack[nodeIndex] = true;
+		callStack.Add(TPair<int32, int32>(nodeIndex, graph.m_EdgeOffsets[nodeIndex]));
+	};
+
+	for (int32 root = 0; root < amountOfNodes; root++)
+	{
+		if (visitIndexes[root] != -1)
+		{
+			continue;
+		}
+
+		visit(root);
+		while (callStack.Num() != 0)
+		{
+			const int32 currentIndex = callStack.Last().Key;
+			const int32 edge = callStack.Last().Value;
+
+			if (edge < graph.m_EdgeOffsets[currentIndex + 1])
+			{
+				callStack.Last().Value++;
+				const int32 otherIndex = graph.m_EdgeTargets[edge];
+				if (visitIndexes[otherIndex] == -1)
+				{
+					visit(otherIndex);
+				}
+				else if (isOnStack[otherIndex])
+				{
+					lowLinks[currentIndex] = FMath::Min(lowLinks[currentIndex], visitIndexes[otherIndex]);
+				}
+				continue;
+			}
+
+			// all edges visited, when this is the root of a component pop the whole component
+			if (lowLinks[currentIndex] == visitIndexes[currentIndex])
+			{
+				int32 componentNode = -1;
+				do
+				{
+					componentNode = stack.Pop(false);
+					isOnStack[componentNode] = false;
+					m_StrongLabels[componentNode] = m_AmountOfStrongComponents;
+				} while (componentNode != currentIndex);
+				m_AmountOfStrongComponents++;
+			}
+
+			callStack.Pop(false);
+			if (callStack.Num() != 0)
+			{
+				const int32 parentIndex = callStack.Last().Key;
+				lowLinks[parentIndex] = FMath::Min(lowLinks[parentIndex], lowLinks[currentIndex]);
+			}
+		}
+	}
+
+	// weakly connected components (flood fill ignoring the edge direction)
+	m_WeakLabels.Init(-1, amountOfNodes);
+	int32 amountOfWeakComponents = 0;
+	for (int32 root = 0; root < amountOfNodes; root++)
+	{
+		if (m_WeakLabels[root] != -1)
+		{
+			continue;
+		}
+
+		m_WeakLabels[root] = amountOfWeakComponents;
+		stack.Reset();
+		stack.Push(root);
+		while (stack.Num() != 0)
+		{
+			const int32 currentIndex = stack.Pop(false);
+			for (int32 edge = graph.m_EdgeOffsets[currentIndex]; edge < graph.m_EdgeOffsets[currentIndex + 1]; edge++)
+			{
+				const int32 otherIndex = graph.m_EdgeTargets[edge];
+				if (m_WeakLabels[otherIndex] == -1)
+				{
+					m_WeakLabels[otherIndex] = amountOfWeakComponents;
+					stack.Push(otherIndex);
+				}
+			}
+			for (int32 edge = graph.m_ReverseEdgeOffsets[currentIndex]; edge < graph.m_ReverseEdgeOffsets[currentIndex + 1]; edge++)
+			{
+				const int32 otherIndex = graph.m_ReverseEdgeSources[edge];
+				if (m_WeakLabels[otherIndex] == -1)
+				{
+					m_WeakLabels[otherIndex] = amountOfWeakComponents;
+					stack.Push(otherIndex);
+				}
+			}
+		}
+		amountOfWeakComponents++;
+	}
+
+	if (m_AmountOfStrongComponents > MaxComponentsForReachabilityTable)
+	{
+		return;
+	}
+
+	// reachability between strong components, handled in label order so every reached component is already complete
+	m_ReachabilityRowSize = (m_AmountOfStrongComponents + 31) / 32;
+	m_Reachability.Init(0, m_ReachabilityRowSize * m_AmountOfStrongComponents);
+
+	TArray<int32> nodesByLabel{};
+	nodesByLabel.SetNumUninitialized(amountOfNodes);
+	TArray<int32> labelOffsets{};
+	labelOffsets.Init(0, m_AmountOfStrongComponents + 1);
+	for (int32 label : m_StrongLabels)
+	{
+		labelOffsets[label + 1]++;
+	}
+	for (int32 i = 0; i < m_AmountOfStrongComponents; i++)
+	{
+		labelOffsets[i + 1] += labelOffsets[i];
+	}
+	TArray<int32> writeIndexes(labelOffsets.GetData(), m_AmountOfStrongComponents);
+	for (int32 i = 0; i < amountOfNodes; i++)
+	{
+		nodesByLabel[writeIndexes[m_StrongLabels[i]]++] = i;
+	}
+
+	for (int32 label = 0; label < m_AmountOfStrongComponents; label++)
+	{
+		uint32* pRow = m_Reachability.GetData() + label * m_ReachabilityRowSize;
+		pRow[label / 32] |= 1u << (label % 32);
+
+		for (int32 i = labelOffsets[label]; i < labelOffsets[label + 1]; i++)
+		{
+			const int32 currentIndex = nodesByLabel[i];
+			for (int32 edge = graph.m_EdgeOffsets[currentIndex]; edge < graph.m_EdgeOffsets[currentIndex + 1]; edge++)
+			{
+				const int32 otherLabel = m_StrongLabels[graph.m_EdgeTargets[edge]];
+				if (otherLabel == label)
+				{
+					continue;
+				}
+
+				const uint32* pOtherRow = m_Reachability.GetData() + otherLabel * m_ReachabilityRowSize;
+				for (int32 word = 0; word < m_ReachabilityRowSize; word++)
+				{
+					pRow[word] |= pOtherRow[word];
+				}
+			}
+		}
+	}
+}
+
+
+
+bool FAIPathComponents::CanReach(int32 fromNode, int32 toNode) const
+{
+	const int32 fromLabel = m_StrongLabels[fromNode];
+	const int32 toLabel = m_StrongLabels[toNode];
+
+	if (fromLabel == toLabel)
+	{
+		return true;
+	}
+
+	if (m_WeakLabels[fromNode] != m_WeakLabels[toNode] || fromLabel < toLabel)
+	{
+		return false;
+	}
+
+	if (HasReachabilityTable())
+	{
+		return (m_Reachability[fromLabel * m_ReachabilityRowSize + toLabel / 32] & (1u << (toLabel % 32))) != 0;
+	}
+
+	return true;
+}
+
+
+
+bool FAIPathComponents::HasReachabilityTable() const
+{
+	return m_ReachabilityRowSize != 0;
+}
+
+
+
+//
+// AIPathOpenEntry
+//
+
+FAIPathOpenEntry::FAIPathOpenEntry(float key, int32 node)
+	: m_Key{ key }
+	, m_Node{ node }
+{
+}
+
+
+
+//
+// AIPathSearch
+//
+
+/// <summary>
+/// Clears all previous search data and puts the begin node in the open list.
+/// </summary>
+/// <param name="amountOfNodes">Amount of nodes in the searched graph</param>
+/// <param name="beginNode">The node index the search starts from</param>
+void FAIPathSearch::Reset(int32 amountOfNodes, int32 beginNode)
+{
+	m_BeginNode = beginNode;
+	m_Distances.Init(FLT_MAX, amountOfNodes);
+	m_PreviousNodes.Init(-1, amountOfNodes);
+	m_Settled.Init(false, amountOfNodes);
+	m_Open.Reset();
+	m_AmountOfExpansions = 0;
+
+	m_Distances[beginNode] = 0.0f;
+	m_PreviousNodes[beginNode] = beginNode;
+	m_Open.HeapPush(FAIPathOpenEntry(0.0f, beginNode));
+}
+
+
+
+bool FAIPathSearch::IsSettled(int32 node) const
+{
+	return m_Settled[node];
+}
+
+
+
+bool FAIPathSearch::IsExhausted() const
+{
+	return m_Open.Num() == 0;
+}
+
+
+
+float FAIPathSearch::GetOpenMinimum() const
+{
+	return (m_Open.Num() != 0) ? m_Open.HeapTop().m_Key : FLT_MAX;
+}
+
+
+
+/// <summary>
+/// Follows m_PreviousNodes back from toNode and returns the path in order from begin node to toNode.
+/// </summary>
+/// <param name="toNode">Node index the path should end at</param>
+/// <param name="outPath">Gets overwritten with the path</param>
+/// <returns>If toNode was settled and a path could be made</returns>
+bool FAIPathSearch::BuildPath(int32 toNode, TArray<int32>& outPath) const
+{
+	outPath.Reset();
+	if (!IsSettled(toNode))
+	{
+		return false;
+	}
+
+	int32 currentToNode = toNode;
+	while (currentToNode != m_PreviousNodes[currentToNode])
+	{
+		outPath.Add(currentToNode);
+		currentToNode = m_PreviousNodes[currentToNode];
+	}
+	outPath.Add(currentToNode); // adding the final node ( first node )
+
+	Algo::Reverse(outPath);
+	return true;
+}
+
+
+
+//
+// AIPathLandmarks
+//
+
+void FAIPathLandmarks::Empty()
+{
+	m_LandmarkNodes.Empty();
+	m_DistancesFrom.Empty();
+	m_DistancesTo.Empty();
+}
+
+
+
+int32 FAIPathLandmarks::Num() const
+{
+	return m_LandmarkNodes.Num();
+}
+
+
+
+/// <summary>
+/// Uses the triangle inequality on every landmark and returns the biggest bound.
+/// d(L, target) <= d(L, node) + d(node, target) and d(node, L) <= d(node, target) + d(target, L)
+/// </summary>
+/// <param name="node">Node index the distance starts from</param>
+/// <param name="targetNode">Node index the distance ends at</param>
+/// <returns>A value that is never bigger than the shortest distance from node to targetNode</returns>
+float FAIPathLandmarks::GetLowerBound(int32 node, int32 targetNode) const
+{
+	const int32 amountOfLandmarks = m_LandmarkNodes.Num();
+	const float* pFromNode = m_DistancesFrom.GetData() + node * amountOfLandmarks;
+	const float* pFromTarget = m_DistancesFrom.GetData() + targetNode * amountOfLandmarks;
+	const float* pToNode = m_DistancesTo.GetData() + node * amountOfLandmarks;
+	const float* pToTarget = m_DistancesTo.GetData() + targetNode * amountOfLandmarks;
+
+	float lowerBound = 0.0f;
+	for (int32 l = 0; l < amountOfLandmarks; l++)
+	{
+		if (pFromTarget[l] != FLT_MAX)
+		{
+			if (pFromNode[l] != FLT_MAX)
+			{
+				lowerBound = FMath::Max(lowerBound, pFromTarget[l] - pFromNode[l]);
+			}
+		}
+		else if (pFromNode[l] != FLT_MAX)
+		{
+			return FLT_MAX; // the landmark reaches node but not targetNode, so node cant reach targetNode
+		}
+
+		if (pToNode[l] != FLT_MAX)
+		{
+			if (pToTarget[l] != FLT_MAX)
+			{
+				lowerBound = FMath::Max(lowerBound, pToNode[l] - pToTarget[l]);
+			}
+		}
+		else if (pToTarget[l] != FLT_MAX)
+		{
+			return FLT_MAX; // targetNode reaches the landmark but node doesnt, so node cant reach targetNode
+		}
+	}
+
+	return lowerBound;
+}
+
+
+
+//
+// cost policies
+//
+
+FAIPathSquaredDistanceCost::FAIPathSquaredDistanceCost(const FAIPathGraph& graph)
+	: m_pWeights{ graph.m_EdgeWeights.GetData() }
+{
+}
+
+
+
+FAIPathDistanceCost::FAIPathDistanceCost(const FAIPathGraph& graph)
+	: m_pLengths{ graph.m_EdgeLengths.GetData() }
+{
+}
+
+
+
+//
+// AIPathLandmarkHeuristic
+//
+
+FAIPathLandmarkHeuristic::FAIPathLandmarkHeuristic(const FAIPathLandmarks& landmarks, int32 targetNode)
+	: m_Landmarks{ landmarks }
+	, m_TargetNode{ targetNode }
+{
+}
+
+
+
+//
+// node orders
+//
+
+/// <summary>
+/// Cuthill mckee ordering, nodes that are connected end up close to each other so a search touches less memory.
+/// </summary>
+/// <param name="graph">Graph in authoring order, needs its reverse edges</param>
+/// <returns>The authoring index for every runtime index</returns>
+TArray<int32> ComputeCuthillMcKeeOrder(const FAIPathGraph& graph)
+{
+	const int32 amountOfNodes = graph.Num();
+
+	TArray<int32> degrees{};
+	degrees.SetNumUninitialized(amountOfNodes);
+	for (int32 i = 0; i < amountOfNodes; i++)
+	{
+		degrees[i] = (graph.m_EdgeOffsets[i + 1] - graph.m_EdgeOffsets[i]) + (graph.m_ReverseEdgeOffsets[i + 1] - graph.m_ReverseEdgeOffsets[i]);
+	}
+
+	// lowest degree nodes first, these are the best starting points (ends of corridors, dead ends)
+	TArray<int32> nodesByDegree{};
+	nodesByDegree.SetNumUninitialized(amountOfNodes);
+	for (int32 i = 0; i < amountOfNodes; i++)
+	{
+		nodesByDegree[i] = i;
+	}
+	nodesByDegree.StableSort([&degrees](int32 a, int32 b) { return degrees[a] < degrees[b]; });
+
+	TArray<int32> runtimeToAuthoring{};
+	runtimeToAuthoring.Reserve(amountOfNodes);
+	TBitArray<> isVisited(false, amountOfNodes);
+	TArray<int32> neighbours{};
+
+	for (int32 root : nodesByDegree)
+	{
+		if (isVisited[root])
+		{
+			continue;
+		}
+
+		// runtimeToAuthoring doubles as the breadth first queue
+		int32 queueIndex = runtimeToAuthoring.Add(root);
+		isVisited[root] = true;
+
+		for (; queueIndex < runtimeToAuthoring.Num(); queueIndex++)
+		{
+			const int32 currentIndex = runtimeToAuthoring[queueIndex];
+
+			neighbours.Reset();
+			for (int32 edge = graph.m_EdgeOffsets[currentIndex]; edge < graph.m_EdgeOffsets[currentIndex + 1]; edge++)
+			{
+				neighbours.Add(graph.m_EdgeTargets[edge]);
+			}
+			for (int32 edge = graph.m_ReverseEdgeOffsets[currentIndex]; edge < graph.m_ReverseEdgeOffsets[currentIndex + 1]; edge++)
+			{
+				neighbours.Add(graph.m_ReverseEdgeSources[edge]);
+			}
+			neighbours.StableSort([&degrees](int32 a, int32 b) { return degrees[a] < degrees[b]; });
+
+			for (int32 otherIndex : neighbours)
+			{
+				if (!isVisited[otherIndex])
+				{
+					isVisited[otherIndex] = true;
+					runtimeToAuthoring.Add(otherIndex);
+				}
+			}
+		}
+	}
+
+	return runtimeToAuthoring;
+}
+
+
+
+/// <summary>
+/// Hilbert curve ordering, nodes that are close in the level end up close to each other in memory.
+/// Only uses X and Y since path networks are mostly flat, nodes above each other end up next to each other.
+/// </summary>
+/// <param name="locations">Location of every node in authoring order</param>
+/// <returns>The authoring index for every runtime index</returns>
+TArray<int32> ComputeHilbertOrder(const TArray<FVector>& locations)
+{
+	const int32 amountOfNodes = locations.Num();
+	constexpr uint32 gridSize = 1u << 16;
+
+	const FBox bounds(locations);
+	const FVector boundsSize = bounds.GetSize();
+	const float cellScale = float(gridSize - 1) / FMath::Max(FMath::Max(boundsSize.X, boundsSize.Y), KINDA_SMALL_NUMBER);
+
+	// <distance along the curve, authoring index>
+	TArray<TPair<uint64, int32>> curveDistances{};
+	curveDistances.SetNumUninitialized(amountOfNodes);
+	for (int32 i = 0; i < amountOfNodes; i++)
+	{
+		uint32 x = uint32((locations[i].X - bounds.Min.X) * cellScale);
+		uint32 y = uint32((locations[i].Y - bounds.Min.Y) * cellScale);
+
+		uint64 curveDistance = 0;
+		for (uint32 cellSize = gridSize / 2; cellSize > 0; cellSize /= 2)
+		{
+			const uint32 rotateX = (x & cellSize) ? 1 : 0;
+			const uint32 rotateY = (y & cellSize) ? 1 : 0;
+			curveDistance += uint64(cellSize) * uint64(cellSize) * ((3 * rotateX) ^ rotateY);
+
+			// rotating the quadrant so the curve stays continuous
+			if (rotateY == 0)
+			{
+				if (rotateX == 1)
+				{
+					x = gridSize - 1 - x;
+					y = gridSize - 1 - y;
+				}
+				Swap(x, y);
+			}
+		}
+
+		curveDistances[i] = TPair<uint64, int32>(curveDistance, i);
+	}
+
+	curveDistances.StableSort([](const TPair<uint64, int32>& a, const TPair<uint64, int32>& b) { return a.Key < b.Key; });
+
+	TArray<int32> runtimeToAuthoring{};
+	runtimeToAuthoring.SetNumUninitialized(amountOfNodes);
+	for (int32 i = 0; i < amountOfNodes; i++)
+	{
+		runtimeToAuthoring[i] = curveDistances[i].Value;
+	}
+	return runtimeToAuthoring;
+}
+
+
+
+//
+// search functions
+//
+
+/// <summary>
+/// Farthest point selection : the first landmark is the node farthest away from node 0,
+/// every next landmark is the node farthest away from all landmarks picked so far.
+/// Nodes that no landmark reaches (or is reached by) count as infinitely far so every island gets a landmark.
+/// Needs 2 full searches per landmark, so this is intended to run once at level load.
+/// </summary>
+/// <param name="graph">The graph to pick landmarks in</param>
+/// <param name="cost">The edge cost policy the distances get measured with</param>
+/// <param name="amountOfLandmarks">Amount of landmarks to pick, more landmarks gives better bounds but costs O(amount * nodes) memory</param>
+/// <param name="outLandmarks">Gets overwritten with the picked landmarks and their distances</param>
+template<typename TCost>
+void BuildLandmarks(const FAIPathGraph& graph, const TCost& cost, int32 amountOfLandmarks, FAIPathLandmarks& outLandmarks)
+{
+	outLandmarks.Empty();
+	const int32 amountOfNodes = graph.Num();
+	amountOfLandmarks = FMath::Min(amountOfLandmarks, amountOfNodes);
+	if (amountOfLandmarks <= 0)
+	{
+		return;
+	}
+
+	outLandmarks.m_LandmarkNodes.Reserve(amountOfLandmarks);
+	outLandmarks.m_DistancesFrom.SetNumUninitialized(amountOfNodes * amountOfLandmarks);
+	outLandmarks.m_DistancesTo.SetNumUninitialized(amountOfNodes * amountOfLandmarks);
+
+	FAIPathSearch search{};
+	auto searchEverything = [](int32 nodeIndex) { return false; };
+
+	// distance of each node to its closest landmark picked so far
+	TArray<float> closestLandmarkDistances{};
+	closestLandmarkDistances.Init(FLT_MAX, amountOfNodes);
+
+	auto pickFarthestNode = [&](const TArray<float>& distances)
+	{
+		int32 farthestNode = 0;
+		for (int32 i = 1; i < amountOfNodes; i++)
+		{
+			if (distances[i] > distances[farthestNode])
+			{
+				farthestNode = i;
+			}
+		}
+		return farthestNode;
+	};
+
+	// first landmark is the farthest reachable node from node 0
+	search.Reset(amountOfNodes, 0);
+	AdvanceSearch(graph, cost, search, searchEverything);
+	for (float& distance : search.m_Distances)
+	{
+		distance = (distance == FLT_MAX) ? -1.0f : distance;
+	}
+	int32 landmarkNode = pickFarthestNode(search.m_Distances);
+
+	for (int32 l = 0; l < amountOfLandmarks; l++)
+	{
+		outLandmarks.m_LandmarkNodes.Add(landmarkNode);
+
+		search.Reset(amountOfNodes, landmarkNode);
+		AdvanceSearch(graph, cost, search, searchEverything);
+		for (int32 i = 0; i < amountOfNodes; i++)
+		{
+			outLandmarks.m_DistancesFrom[i * amountOfLandmarks + l] = search.m_Distances[i];
+			closestLandmarkDistances[i] = FMath::Min(closestLandmarkDistances[i], search.m_Distances[i]);
+		}
+
+		search.Reset(amountOfNodes, landmarkNode);
+		AdvanceSearch<true>(graph, cost, search, searchEverything);
+		for (int32 i = 0; i < amountOfNodes; i++)
+		{
+			outLandmarks.m_DistancesTo[i * amountOfLandmarks + l] = search.m_Distances[i];
+			closestLandmarkDistances[i] = FMath::Min(closestLandmarkDistances[i], search.m_Distances[i]);
+		}
+
+		landmarkNode = pickFarthestNode(closestLandmarkDistances);
+	}
+}
+
+
+
+
+/// <summary>
+/// Alternates between a forward search from beginNode and a backward search from endNode (over the reverse edges),
+/// always advancing the side with the smallest open distance.
+/// Each settled node tries to connect both searches over its edges, the best connection found is the shortest path
+/// once the sum of both open minimums is not smaller than it anymore.
+/// </summary>
+/// <param name="graph">The graph to search in</param>
+/// <param name="cost">The edge cost policy</param>
+/// <param name="beginNode">The node index the path starts from</param>
+/// <param name="endNode">The node index the path ends at</param>
+/// <param name="outPath">Gets overwritten with the path from beginNode till endNode</param>
+/// <returns>If a path exists</returns>
+template<typename TCost>
+bool BidirectionalSearch(const FAIPathGraph& graph, const TCost& cost, int32 beginNode, int32 endNode, TArray<int32>& outPath)
+{
+	outPath.Reset();
+	const int32 amountOfNodes = graph.Num();
+
+	FAIPathSearch forward{};
+	FAIPathSearch backward{};
+	forward.Reset(amountOfNodes, beginNode);
+	backward.Reset(amountOfNodes, endNode);
+
+	// shortest connection found so far, begin till meetForward -> edge -> meetBackward till end
+	float bestDistance = (beginNode == endNode) ? 0.0f : FLT_MAX;
+	int32 meetForward = beginNode;
+	int32 meetBackward = endNode;
+
+	auto onForwardSettled = [&](int32 nodeIndex)
+	{
+		for (int32 edge = graph.m_EdgeOffsets[nodeIndex]; edge < graph.m_EdgeOffsets[nodeIndex + 1]; edge++)
+		{
+			const int32 otherIndex = graph.m_EdgeTargets[edge];
+			const float distance = forward.m_Distances[nodeIndex] + cost(edge) + backward.m_Distances[otherIndex];
+			if (backward.m_Distances[otherIndex] != FLT_MAX && distance < bestDistance)
+			{
+				bestDistance = distance;
+				meetForward = nodeIndex;
+				meetBackward = otherIndex;
+			}
+		}
+		return true; // one node at a time
+	};
+
+	auto onBackwardSettled = [&](int32 nodeIndex)
+	{
+		for (int32 edge = graph.m_ReverseEdgeOffsets[nodeIndex]; edge < graph.m_ReverseEdgeOffsets[nodeIndex + 1]; edge++)
+		{
+			const int32 otherIndex = graph.m_ReverseEdgeSources[edge];
+			const float distance = backward.m_Distances[nodeIndex] + cost(graph.m_ReverseEdgeIndices[edge]) + forward.m_Distances[otherIndex];
+			if (forward.m_Distances[otherIndex] != FLT_MAX && distance < bestDistance)
+			{
+				bestDistance = distance;
+				meetForward = otherIndex;
+				meetBackward = nodeIndex;
+			}
+		}
+		return true; // one node at a time
+	};
+
+	while (!forward.IsExhausted() && !backward.IsExhausted())
+	{
+		const float forwardMinimum = forward.GetOpenMinimum();
+		const float backwardMinimum = backward.GetOpenMinimum();
+		if (forwardMinimum + backwardMinimum >= bestDistance)
+		{
+			break; // no unsettled connection can be shorter anymore
+		}
+
+		if (forwardMinimum <= backwardMinimum)
+		{
+			AdvanceSearch(graph, cost, forward, onForwardSettled);
+		}
+		else
+		{
+			AdvanceSearch<true>(graph, cost, backward, onBackwardSettled);
+		}
+	}
+
+	if (bestDistance == FLT_MAX)
+	{
+		return false;
+	}
+
+	// forward part ( begin till meetForward )
+	int32 currentNode = meetForward;
+	while (currentNode != beginNode)
+	{
+		outPath.Add(currentNode);
+		currentNode = forward.m_PreviousNodes[currentNode];
+	}
+	outPath.Add(beginNode);
+	Algo::Reverse(outPath);
+
+	if (meetForward == meetBackward)
+	{
+		return true; // only happens when beginNode == endNode
+	}
+
+	// backward part ( meetBackward till end ), the previous nodes of the backward search point towards endNode
+	currentNode = meetBackward;
+	while (currentNode != endNode)
+	{
+		outPath.Add(currentNode);
+		currentNode = backward.m_PreviousNodes[currentNode];
+	}
+	outPath.Add(endNode);
+
+	return true;
+}
+
+
+
+// the templated search functions are only instantiated for the cost policies used by the agent profiles (AAIPathNetwork)
+#define AIPATH_INSTANTIATE_COST_POLICY(TCost) \
+	template void BuildLandmarks<TCost>(const FAIPathGraph& graph, const TCost& cost, int32 amountOfLandmarks, FAIPathLandmarks& outLandmarks); \
+	template bool BidirectionalSearch<TCost>(const FAIPathGraph& graph, const TCost& cost, int32 beginNode, int32 endNode, TArray<int32>& outPath);
+
+AIPATH_INSTANTIATE_COST_POLICY(FAIPathSquaredDistanceCost)
+AIPATH_INSTANTIATE_COST_POLICY(FAIPathDistanceCost)
+AIPATH_INSTANTIATE_COST_POLICY(TAIPathPenalizedCost<FAIPathSquaredDistanceCost>)
+AIPATH_INSTANTIATE_COST_POLICY(TAIPathPenalizedCost<FAIPathDistanceCost>)
+
+#undef AIPATH_INSTANTIATE_COST_POLICY
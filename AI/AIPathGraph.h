@@ -0,0 +1,323 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+
+/// <summary>
+/// Compact runtime version of the node network of an AAIPathNetwork (baked in AAIPathNetwork::Initialize).
+/// All edges are stored in flat arrays so the search loops dont have to go trough the FAIPathNode structs.
+/// Nodes can be renumbered (Reorder) so nodes close to each other in the network are close in memory as well,
+/// everything outside of the search functions keeps using the authoring index (index in AAIPathNetwork::m_NodeContainer).
+/// </summary>
+struct FAIPathGraph
+{
+	void Empty();
+
+	int32 Num() const;
+
+	// fills the reverse edges using the forward edges, has to be called after all forward edges are added
+	void BuildReverseEdges();
+
+	// sets the weight of every edge to the squared distance between its nodes and the length to the distance itself
+	// locations are in authoring order, has to be called after all forward edges are added and before Reorder
+	void ComputeSquaredDistanceWeights(const TArray<FVector>& locations);
+
+	// sets the runtime index of every node equal to its authoring index, has to be called after all forward edges are added
+	void InitializeNodeOrder();
+
+	// renumbers every node, runtimeToAuthoring[x] is the authoring index of the node that gets runtime index x
+	// has to be called on a graph that is still in authoring order
+	void Reorder(const TArray<int32>& runtimeToAuthoring);
+
+	int32 ToRuntime(int32 authoringNode) const;
+	int32 ToAuthoring(int32 runtimeNode) const;
+	void ToAuthoring(TArray<int32>& inOutNodes) const;
+
+	// edges going out of node x are at [m_EdgeOffsets[x], m_EdgeOffsets[x + 1])
+	TArray<int32> m_EdgeOffsets;
+	TArray<int32> m_EdgeTargets;
+	TArray<float> m_EdgeWeights; // squared distance
+	TArray<float> m_EdgeLengths; // distance
+
+	// edges coming into node x are at [m_ReverseEdgeOffsets[x], m_ReverseEdgeOffsets[x + 1])
+	// m_ReverseEdgeIndices points back to the forward edge so the weight is only stored once
+	TArray<int32> m_ReverseEdgeOffsets;
+	TArray<int32> m_ReverseEdgeSources;
+	TArray<int32> m_ReverseEdgeIndices;
+
+	TArray<int32> m_RuntimeToAuthoring;
+	TArray<int32> m_AuthoringToRuntime;
+};
+
+// breadth first order starting from the lowest degree node of each island, visiting neighbours by increasing degree (cuthill mckee)
+// ignores the edge direction, returns the authoring index for every runtime index
+TArray<int32> ComputeCuthillMcKeeOrder(const FAIPathGraph& graph);
+
+// order along a 2D hilbert curve trough the X and Y of each node, returns the authoring index for every runtime index
+TArray<int32> ComputeHilbertOrder(const TArray<FVector>& locations);
+
+/// <summary>
+/// Connected component labels of an FAIPathGraph, used to reject impossible path requests before searching.
+/// Strong labels are given in reverse topological order (tarjan), so a node can only reach nodes with a smaller or equal label.
+/// </summary>
+struct FAIPathComponents
+{
+	// above this amount of strong components the reachability table gets too big to store
+	static constexpr int32 MaxComponentsForReachabilityTable = 1024;
+
+	void Empty();
+
+	void Build(const FAIPathGraph& graph);
+
+	// O(1), false means fromNode can never reach toNode
+	// true is only certain when HasReachabilityTable(), otherwise the nodes might still be unreachable
+	bool CanReach(int32 fromNode, int32 toNode) const;
+
+	bool HasReachabilityTable() const;
+
+	TArray<int32> m_StrongLabels;
+	TArray<int32> m_WeakLabels;
+	int32 m_AmountOfStrongComponents = 0;
+
+	// bit y of row x is set when strong component x can reach strong component y
+	TArray<uint32> m_Reachability;
+	int32 m_ReachabilityRowSize = 0;
+};
+
+struct FAIPathOpenEntry
+{
+	FAIPathOpenEntry(float key = 0.0f, int32 node = -1);
+
+	float m_Key;
+	int32 m_Node;
+
+	bool operator<(const FAIPathOpenEntry& other) const { return m_Key < other.m_Key; }
+};
+
+enum class EAIPathSearchStatus : uint8
+{
+	STOPPED = 0,		// the onSettled callback asked to stop
+	EXHAUSTED = 1,		// every reachable node is settled
+	OUT_OF_BUDGET = 2	// maxExpansions was reached
+};
+
+/// <summary>
+/// State of a single source dijkstra search that can be stopped and resumed at any time.
+/// When searching in reverse m_PreviousNodes holds the next node towards the begin node instead.
+/// </summary>
+struct FAIPathSearch
+{
+	void Reset(int32 amountOfNodes, int32 beginNode);
+
+	bool IsSettled(int32 node) const;
+	bool IsExhausted() const;
+
+	// smallest key still in the open list (FLT_MAX when exhausted), this is the distance when searching without heuristic
+	float GetOpenMinimum() const;
+
+	// fills outPath from m_BeginNode till toNode, returns false when toNode is not settled (yet)
+	bool BuildPath(int32 toNode, TArray<int32>& outPath) const;
+
+	int32 m_BeginNode = -1;
+	TArray<float> m_Distances;
+	TArray<int32> m_PreviousNodes;
+	TBitArray<> m_Settled;
+	TArray<FAIPathOpenEntry> m_Open; // binary heap, can contain outdated entries of already settled nodes
+	int32 m_AmountOfExpansions = 0;
+};
+
+/// <summary>
+/// Landmark distances used as A* heuristic (ALT), distances towards and from each landmark give lower bounds
+/// trough the triangle inequality. Stored per node so a lookup only touches one small block of memory.
+/// </summary>
+struct FAIPathLandmarks
+{
+	void Empty();
+
+	int32 Num() const;
+
+	// lower bound of the distance from node to targetNode, FLT_MAX when node can never reach targetNode
+	float GetLowerBound(int32 node, int32 targetNode) const;
+
+	TArray<int32> m_LandmarkNodes;
+
+	// distance from landmark l to node x is at [x * Num() + l]
+	TArray<float> m_DistancesFrom;
+
+	// distance from node x to landmark l is at [x * Num() + l]
+	TArray<float> m_DistancesTo;
+};
+
+/// <summary>
+/// Edge cost policies, cost(edge) returns the cost of forward edge "edge" and has to be positive.
+/// The search functions are templates over the cost policy so every policy gets its own inner loop without virtual calls or branches.
+/// </summary>
+struct FAIPathSquaredDistanceCost
+{
+	explicit FAIPathSquaredDistanceCost(const FAIPathGraph& graph);
+
+	float operator()(int32 edge) const { return m_pWeights[edge]; }
+
+	const float* m_pWeights;
+};
+
+struct FAIPathDistanceCost
+{
+	explicit FAIPathDistanceCost(const FAIPathGraph& graph);
+
+	float operator()(int32 edge) const { return m_pLengths[edge]; }
+
+	const float* m_pLengths;
+};
+
+// cost of TBaseCost multiplied by a penalty per edge (designer multipliers, terrain penalties, ...)
+template<typename TBaseCost>
+struct TAIPathPenalizedCost
+{
+	TAIPathPenalizedCost(const FAIPathGraph& graph, const TArray<float>& edgePenalties)
+		: m_BaseCost{ graph }
+		, m_pPenalties{ edgePenalties.GetData() }
+	{
+		check(edgePenalties.Num() == graph.m_EdgeTargets.Num());
+	}
+
+	float operator()(int32 edge) const { return m_BaseCost(edge) * m_pPenalties[edge]; }
+
+	TBaseCost m_BaseCost;
+	const float* m_pPenalties;
+};
+
+// picks amountOfLandmarks nodes with farthest point selection and stores the distances towards and from them
+// the landmarks only give valid bounds for searches using the same cost policy
+template<typename TCost>
+void BuildLandmarks(const FAIPathGraph& graph, const TCost& cost, int32 amountOfLandmarks, FAIPathLandmarks& outLandmarks);
+
+// heuristic for plain dijkstra
+struct FAIPathNoHeuristic
+{
+	float operator()(int32 node) const { return 0.0f; }
+};
+
+// landmark heuristic towards a single target node
+struct FAIPathLandmarkHeuristic
+{
+	FAIPathLandmarkHeuristic(const FAIPathLandmarks& landmarks, int32 targetNode);
+
+	float operator()(int32 node) const { return m_Landmarks.GetLowerBound(node, m_TargetNode); }
+
+	const FAIPathLandmarks& m_Landmarks;
+	int32 m_TargetNode;
+};
+
+// inflated heuristic for weighted A*, with a consistent THeuristic the found path costs at most weight times the shortest path
+template<typename THeuristic>
+struct TAIPathWeightedHeuristic
+{
+	TAIPathWeightedHeuristic(const THeuristic& heuristic, float weight)
+		: m_Heuristic{ heuristic }
+		, m_Weight{ weight }
+	{
+		check(weight >= 1.0f);
+	}
+
+	float operator()(int32 node) const
+	{
+		const float estimate = m_Heuristic(node);
+		return (estimate == FLT_MAX) ? FLT_MAX : estimate * m_Weight;
+	}
+
+	THeuristic m_Heuristic;
+	float m_Weight;
+};
+
+/// <summary>
+/// Advances the search by settling nodes in order of distance (+ heuristic when used as A*).
+/// onSettled(nodeIndex) gets called after a node is settled and its edges relaxed, returning true stops the search.
+/// Because edges are relaxed before calling onSettled the search can always be resumed later on.
+/// The heuristic has to be consistent (like FAIPathLandmarkHeuristic) for the settled distances to be the shortest.
+/// With TAIPathWeightedHeuristic nodes dont get opened again, the settled distances are then within its weight of the shortest.
+/// </summary>
+template<bool bReverse = false, typename TCost, typename TOnSettled, typename THeuristic = FAIPathNoHeuristic>
+EAIPathSearchStatus AdvanceSearch(const FAIPathGraph& graph, const TCost& cost, FAIPathSearch& search, TOnSettled&& onSettled, int32 maxExpansions = MAX_int32, const THeuristic& heuristic = THeuristic())
+{
+	const TArray<int32>& offsets = bReverse ? graph.m_ReverseEdgeOffsets : graph.m_EdgeOffsets;
+	const TArray<int32>& targets = bReverse ? graph.m_ReverseEdgeSources : graph.m_EdgeTargets;
+
+	int32 expansions = 0;
+	FAIPathOpenEntry current{};
+	while (search.m_Open.Num() != 0)
+	{
+		if (expansions >= maxExpansions)
+		{
+			return EAIPathSearchStatus::OUT_OF_BUDGET;
+		}
+
+		search.m_Open.HeapPop(current, false);
+		if (search.m_Settled[current.m_Node])
+		{
+			continue; // outdated entry, a shorter one was already handled
+		}
+
+		const int32 currentIndex = current.m_Node;
+		const float currentDistance = search.m_Distances[currentIndex];
+		search.m_Settled[currentIndex] = true;
+		search.m_AmountOfExpansions++;
+		expansions++;
+
+		const int32 edgeEnd = offsets[currentIndex + 1];
+		for (int32 edge = offsets[currentIndex]; edge < edgeEnd; edge++)
+		{
+			const int32 otherIndex = targets[edge];
+			const float otherDistance = currentDistance + cost(bReverse ? graph.m_ReverseEdgeIndices[edge] : edge);
+
+			if (!(search.m_Distances[otherIndex] > otherDistance))
+			{
+				continue;
+			}
+
+			// no decrease key, the old entry just gets skipped when popped
+			search.m_Distances[otherIndex] = otherDistance;
+			search.m_PreviousNodes[otherIndex] = currentIndex;
+			search.m_Open.HeapPush(FAIPathOpenEntry(otherDistance + heuristic(otherIndex), otherIndex));
+		}
+
+		if (onSettled(currentIndex))
+		{
+			return EAIPathSearchStatus::STOPPED;
+		}
+	}
+
+	return EAIPathSearchStatus::EXHAUSTED;
+}
+
+/// <summary>
+/// Same as AdvanceSearch but also stops once deadlineSeconds (FPlatformTime::Seconds) has passed.
+/// The time only gets checked every few expansions, so it can go over the deadline by the time of those few expansions.
+/// </summary>
+template<bool bReverse = false, typename TCost, typename TOnSettled, typename THeuristic = FAIPathNoHeuristic>
+EAIPathSearchStatus AdvanceSearchTimeSliced(const FAIPathGraph& graph, const TCost& cost, FAIPathSearch& search, TOnSettled&& onSettled, int32 maxExpansions, double deadlineSeconds, const THeuristic& heuristic = THeuristic())
+{
+	constexpr int32 expansionsPerTimeCheck = 32;
+
+	while (maxExpansions > 0)
+	{
+		const int32 batchExpansions = FMath::Min(maxExpansions, expansionsPerTimeCheck);
+		const EAIPathSearchStatus status = AdvanceSearch<bReverse>(graph, cost, search, onSettled, batchExpansions, heuristic);
+		if (status != EAIPathSearchStatus::OUT_OF_BUDGET)
+		{
+			return status;
+		}
+
+		maxExpansions -= batchExpansions;
+		if (FPlatformTime::Seconds() >= deadlineSeconds)
+		{
+			break;
+		}
+	}
+
+	return EAIPathSearchStatus::OUT_OF_BUDGET;
+}
+
+// Dijkstra from both ends at once using the reverse edges, fills outPath from beginNode till endNode
+// returns false when there is no path
+template<typename TCost>
+bool BidirectionalSearch(const FAIPathGraph& graph, const TCost& cost, int32 beginNode, int32 endNode, TArray<int32>& outPath);
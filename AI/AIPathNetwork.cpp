@@ -1,7 +1,10 @@
 #include "AIPathNetwork.h"
+#include "AIPathWorldSubsystem.h"
 #include "Kismet/KismetSystemLibrary.h"
 #include "Engine/Engine.h"
 #include "Engine/World.h"
+#include "Algo/Reverse.h"
+#include "Misc/App.h"
 #include "../Helpers.h"
 
 //
@@ -42,6 +45,41 @@ void AAIPathNetwork::BeginPlay()
 {
 	Super::BeginPlay();
 	Initialize();
+
+	// only at BeginPlay, OnConstruction gets called way too often in the editor to do this every time
+	if (m_AmountOfLandmarks > 0)
+	{
+		PrecomputeLandmarks(m_AmountOfLandmarks);
+	}
+
+	// also happens when the sublevel of this network streams in
+	if (UAIPathWorldSubsystem* pWorldSubsystem = GetWorld()->GetSubsystem<UAIPathWorldSubsystem>())
+	{
+		pWorldSubsystem->RegisterNetwork(this);
+	}
+}
+
+
+
+void AAIPathNetwork::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// also happens when the sublevel of this network streams out
+	if (UAIPathWorldSubsystem* pWorldSubsystem = GetWorld()->GetSubsystem<UAIPathWorldSubsystem>())
+	{
+		pWorldSubsystem->UnregisterNetwork(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+
+void AAIPathNetwork::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UpdateTimeSlicedSearches();
+	UpdateSuboptimality();
 }
 
 // DEBUG - EDITOR only
@@ -57,9 +95,8 @@ void AAIPathNetwork::PostEditChangeProperty(FPropertyChangedEvent& propertyChang
 
 	if (propertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(AAIPathNetwork, m_NodeContainer))
 	{
-		LogText(ELogVerbosity::Log, L"AAIPathNetwork::PostEditChangeProperty m_NodeContainer size was changed!");
-		InitializeStoredPathData();
-		m_AmountOfNodes = m_NodeContainer.Num();
+		LOG_TEXT(Log, TEXT("AAIPathNetwork::PostEditChangeProperty m_NodeContainer size was changed!"));
+		Initialize(); // also relabels the components
 		DebugDraw();
 	}
 
@@ -67,6 +104,20 @@ void AAIPathNetwork::PostEditChangeProperty(FPropertyChangedEvent& propertyChang
 	{
 		InitializeStoredPathData();
 	}
+
+	// connections changed so the components can be different now
+	if (propertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(FAIPathNode, m_ConnectedNodeIndexes))
+	{
+		Initialize();
+	}
+
+	// the edge penalties of the profiles have to be baked again
+	if (propertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(AAIPathNetwork, m_AgentProfiles)
+		|| propertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(FAIPathNode, m_ConnectionCostMultipliers)
+		|| propertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(FAIPathNode, m_TerrainType))
+	{
+		Initialize();
+	}
 }
 #endif // WITH_EDITOR
 
@@ -145,6 +196,8 @@ void AAIPathNetwork::Initialize()
 {
 	m_AmountOfNodes = m_NodeContainer.Num(); // do not move this line below InitializeStoredPathData or there will be some issues
 	InitializeNodes();
+	BuildRuntimeGraph();
+	BuildProfileData(); // also removes the landmarks, these no longer match the runtime graph
 	InitializeStoredPathData();
 }
 
@@ -165,16 +218,141 @@ void AAIPathNetwork::InitializeNodes()
 
 
 /// <summary>
-/// Makes sure m_storedPathData has the correct size and has no data inside of it yet
+/// Makes sure the stored path data of every profile has no data inside of it yet, entries only get added once a begin node is asked for
 /// </summary>
 void AAIPathNetwork::InitializeStoredPathData()
 {
-	TArray<FAIPathData> emptyArr{};
-	m_StoredPathData.Empty(); // making sure the stored path data is empty
-	m_StoredPathData.Reserve(m_AmountOfNodes); // pre alocates enough memory for the array
-	for (int32 i = 0; i < m_AmountOfNodes; i++)
+	for (FAIPathProfileData& profileData : m_ProfileData)
+	{
+		profileData.m_StoredPathData.Empty(); // making sure the stored path data is empty
+		profileData.m_PartialPathSearches.Empty();
+	}
+
+	// these were searching in the old network, the callers still get told so they dont wait forever.
+	// cleared before broadcasting so listeners can already request new searches
+	const TArray<FAIPathTimeSlicedSearch> cancelledSearches = MoveTemp(m_TimeSlicedSearches);
+	m_TimeSlicedSearches.Empty();
+	for (const FAIPathTimeSlicedSearch& cancelledSearch : cancelledSearches)
+	{
+		m_OnTimeSlicedPathCompleted.Broadcast(cancelledSearch.m_Handle, FAIPath{});
+	}
+}
+
+
+
+/// <summary>
+/// Bakes m_NodeContainer into m_RuntimeGraph, has to be called after the nodes are initialized (needs valid connections).
+/// The edge weights get computed for all nodes at once, on big networks spread over the worker threads.
+/// </summary>
+void AAIPathNetwork::BuildRuntimeGraph()
+{
+	m_RuntimeGraph.Empty();
+	m_RuntimeGraph.m_EdgeOffsets.Reserve(m_AmountOfNodes + 1);
+	m_RuntimeGraph.m_EdgeOffsets.Add(0);
+
+	TArray<FVector> locations{};
+	locations.Reserve(m_AmountOfNodes);
+	for (const FAIPathNode& node : m_NodeContainer)
+	{
+		locations.Add(node.m_Location);
+		m_RuntimeGraph.m_EdgeTargets.Append(node.m_ConnectedNodeIndexes);
+		m_RuntimeGraph.m_EdgeOffsets.Add(m_RuntimeGraph.m_EdgeTargets.Num());
+	}
+
+	m_RuntimeGraph.ComputeSquaredDistanceWeights(locations);
+	m_RuntimeGraph.BuildReverseEdges();
+	m_RuntimeGraph.InitializeNodeOrder();
+
+	switch (m_RuntimeNodeOrdering)
+	{
+	case EAIPathNodeOrdering::BREADTH_FIRST:
+		m_RuntimeGraph.Reorder(ComputeCuthillMcKeeOrder(m_RuntimeGraph));
+		break;
+
+	case EAIPathNodeOrdering::HILBERT_CURVE:
+		m_RuntimeGraph.Reorder(ComputeHilbertOrder(locations));
+		break;
+
+	default:
+		break;
+	}
+
+	m_Components.Build(m_RuntimeGraph);
+}
+
+
+
+/// <summary>
+/// Creates the data of every agent profile and bakes the connection multipliers and terrain penalties into one penalty per runtime edge.
+/// Has to be called after BuildRuntimeGraph.
+/// </summary>
+void AAIPathNetwork::BuildProfileData()
+{
+	const int32 amountOfProfiles = FMath::Max(m_AgentProfiles.Num(), 1);
+	m_ProfileData.Empty(amountOfProfiles);
+	m_ProfileData.SetNum(amountOfProfiles);
+
+	for (int32 p = 0; p < m_AgentProfiles.Num(); p++)
+	{
+		const FAIPathAgentProfile& profile = m_AgentProfiles[p];
+		FAIPathProfileData& profileData = m_ProfileData[p];
+		profileData.m_EdgeCost = profile.m_EdgeCost;
+
+		bool bHasPenalties = false;
+		profileData.m_EdgePenalties.SetNumUninitialized(m_RuntimeGraph.m_EdgeTargets.Num());
+		for (int32 runtimeNode = 0; runtimeNode < m_AmountOfNodes; runtimeNode++)
+		{
+			// the edges of a runtime node are the connections of its authoring node in the same order
+			const FAIPathNode& node = m_NodeContainer[m_RuntimeGraph.ToAuthoring(runtimeNode)];
+			const int32 firstEdge = m_RuntimeGraph.m_EdgeOffsets[runtimeNode];
+			for (int32 edge = firstEdge; edge < m_RuntimeGraph.m_EdgeOffsets[runtimeNode + 1]; edge++)
+			{
+				const int32 connection = edge - firstEdge;
+				const int32 terrainType = m_NodeContainer[m_RuntimeGraph.ToAuthoring(m_RuntimeGraph.m_EdgeTargets[edge])].m_TerrainType;
+
+				float penalty = IsValidIndex(terrainType, profile.m_TerrainPenalties) ? profile.m_TerrainPenalties[terrainType] : 1.0f;
+				if (profile.m_bUseConnectionMultipliers && IsValidIndex(connection, node.m_ConnectionCostMultipliers))
+				{
+					penalty *= node.m_ConnectionCostMultipliers[connection];
+				}
+
+				// a penalty of 0 or less would break the search, removing connections has to happen in m_ConnectedNodeIndexes
+				profileData.m_EdgePenalties[edge] = FMath::Max(penalty, KINDA_SMALL_NUMBER);
+				bHasPenalties |= (penalty != 1.0f);
+			}
+		}
+
+		if (!bHasPenalties)
+		{
+			profileData.m_EdgePenalties.Empty(); // uses the cost policy without the penalty lookup
+		}
+	}
+}
+
+
+
+/// <summary>
+/// Every edge cost policy (and so every search function instantiation) gets picked here, once per query instead of once per edge.
+/// </summary>
+/// <param name="profileData">The profile to use the cost policy of</param>
+/// <param name="function">Generic callable taking the cost policy, all instantiations have to return the same type</param>
+/// <returns>Whatever function returns</returns>
+template<typename TFunction>
+auto AAIPathNetwork::VisitEdgeCost(const FAIPathProfileData& profileData, TFunction&& function) const
+{
+	const bool bIsPenalized = profileData.m_EdgePenalties.Num() != 0;
+
+	switch (profileData.m_EdgeCost)
 	{
-		m_StoredPathData.Add(TPair<int32, TArray<FAIPathData>>(i, emptyArr));
+	case EAIPathEdgeCost::DISTANCE:
+		return bIsPenalized
+			? function(TAIPathPenalizedCost<FAIPathDistanceCost>(m_RuntimeGraph, profileData.m_EdgePenalties))
+			: function(FAIPathDistanceCost(m_RuntimeGraph));
+
+	default:
+		return bIsPenalized
+			? function(TAIPathPenalizedCost<FAIPathSquaredDistanceCost>(m_RuntimeGraph, profileData.m_EdgePenalties))
+			: function(FAIPathSquaredDistanceCost(m_RuntimeGraph));
 	}
 }
 
@@ -184,68 +362,89 @@ void AAIPathNetwork::InitializeStoredPathData()
 /// This function calculates all shortest paths from beginNode till any node that it can possibly
 /// reach in the node network. It uses dijkstra to achieve this, after it has calculated the shortest path
 /// for node at index "beginNode" then it stores it at m_StoredPathData["beginNode"].
+/// When an early exit search from beginNode was stored it gets continued instead of starting over.
 /// </summary>
+/// <param name="profileData">The agent profile to calculate (and store) the paths for</param>
 /// <param name="beginNode">The node index from wich all paths will be calculated from</param>
-void AAIPathNetwork::CalculatePathData(int32 beginNode)
+void AAIPathNetwork::CalculatePathData(FAIPathProfileData& profileData, int32 beginNode)
 {
-	// calculating path data using dijkstra
+	const int32 runtimeBeginNode = m_RuntimeGraph.ToRuntime(beginNode);
+	FAIPathSearch& search = GetPartialPathSearch(profileData, runtimeBeginNode);
+	VisitEdgeCost(profileData, [&](const auto& cost)
+	{
+		AdvanceSearch(m_RuntimeGraph, cost, search, [](int32 nodeIndex) { return false; });
+	});
+
+	StorePathSearch(profileData, search);
+	profileData.m_PartialPathSearches.Remove(runtimeBeginNode);
+}
 
-	// distance, nodeIndex
-	TSet<TPair<float, int32>> toCheck{};
 
-	TPair<float, int32> intializer = TPair<float, int32>(FLT_MAX, -1);
-	TArray<TPair<float, int32>> distances{};
-	
-	// initializing the distances array
-	distances.Reserve(m_AmountOfNodes);
-	for (int32 i = 0; i < m_AmountOfNodes; i++)
+
+bool AAIPathNetwork::IsValidNodeIndex(int32 nodeIndex) const
+{
+	return nodeIndex > -1 && nodeIndex < m_AmountOfNodes;
+}
+
+
+
+int32 AAIPathNetwork::ToValidAgentProfile(int32 agentProfile) const
+{
+	if (IsValidIndex(agentProfile, m_ProfileData))
 	{
-		distances.Add(intializer);
+		return agentProfile;
 	}
-	
-	// setting up start of algorithm
-	distances[beginNode] = TPair<float, int32>(0.0f, beginNode);
-	toCheck.Add(distances[beginNode]);
 
-	while (toCheck.Num() != 0) // this means we still have paths to check
+	LOG_TEXT(Warning, TEXT("AAIPathNetwork::ToValidAgentProfile invalid agent profile [ %d ] using profile 0"), agentProfile);
+	return 0;
+}
+
+
+
+/// <summary>
+/// Returns the stored early exit search from beginNode, or a newly started one if there is none yet.
+/// </summary>
+/// <param name="profileData">The agent profile the search belongs to</param>
+/// <param name="beginNode">The runtime node index the search starts from</param>
+/// <returns>Reference to the search stored in m_PartialPathSearches of the profile</returns>
+FAIPathSearch& AAIPathNetwork::GetPartialPathSearch(FAIPathProfileData& profileData, int32 beginNode)
+{
+	if (FAIPathSearch* pSearch = profileData.m_PartialPathSearches.Find(beginNode))
 	{
-		TPair<float, int32> currentCheck = *toCheck.begin();
-		toCheck.Remove(currentCheck);
-		toCheck.Shrink();
+		return *pSearch;
+	}
 
-		int32 currentIndex = currentCheck.Value;
-		const FAIPathNode& currentNode = m_NodeContainer[currentIndex];
-		int32 amountOfConnectedNodes = currentNode.m_ConnectedNodeIndexes.Num();
+	FAIPathSearch& search = profileData.m_PartialPathSearches.Add(beginNode);
+	search.Reset(m_AmountOfNodes, beginNode);
+	return search;
+}
 
-		for (int32 i = 0; i < amountOfConnectedNodes; i++)
-		{
-			int otherIndex = currentNode.m_ConnectedNodeIndexes[i];
-			float otherWeight = currentNode.GetConnectedNodeWeight(i);
 
-			if (!(distances[otherIndex].Key > (distances[currentIndex].Key + otherWeight)))
-			{
-				continue;
-			}
-			// if shorter path update it
-			
-			// if not max its in our toCheck already
-			// so reinsert it with the new smaller weight
-			if (distances[otherIndex].Key != FLT_MAX)
-			{
-				toCheck.Remove(TPair<float, int32>(distances[otherIndex].Key, otherIndex));
-				toCheck.Shrink();
-			}
 
-				distances[otherIndex] = TPair<float, int32>(distances[currentIndex].Key + otherWeight, currentIndex);
-				toCheck.Add(TPair<float, int32>(distances[otherIndex].Key, otherIndex));
-		}
+/// <summary>
+/// Converts a finished search into path data and stores it in m_StoredPathData of the profile.
+/// The search uses runtime node indexes, the stored path data uses the m_NodeContainer indexes.
+/// </summary>
+/// <param name="profileData">The agent profile the search belongs to</param>
+/// <param name="search">A search that has settled every reachable node</param>
+void AAIPathNetwork::StorePathSearch(FAIPathProfileData& profileData, const FAIPathSearch& search)
+{
+	check(search.IsExhausted());
+
+	// room for every begin node gets reserved at the first store (one allocation, no entries yet)
+	// so adding entries never moves the others and references returned by GetPathData stay valid
+	if (profileData.m_StoredPathData.Num() == 0)
+	{
+		profileData.m_StoredPathData.Reserve(m_AmountOfNodes);
 	}
 
-	TArray<FAIPathData>& storedPathDataRef = m_StoredPathData[beginNode];
-	storedPathDataRef.Empty(); // makes sure TArray is empty 
+	TArray<FAIPathData>& storedPathDataRef = profileData.m_StoredPathData.FindOrAdd(m_RuntimeGraph.ToAuthoring(search.m_BeginNode));
+	storedPathDataRef.Empty(m_AmountOfNodes); // makes sure TArray is empty 
 	for (int32 i = 0; i < m_AmountOfNodes; i++)
 	{
-		storedPathDataRef.Add(FAIPathData(distances[i].Key, distances[i].Value));
+		const int32 runtimeNode = m_RuntimeGraph.ToRuntime(i);
+		const int32 previousNode = search.m_PreviousNodes[runtimeNode];
+		storedPathDataRef.Add(FAIPathData(search.m_Distances[runtimeNode], (previousNode == -1) ? -1 : m_RuntimeGraph.ToAuthoring(previousNode)));
 	}
 }
 
@@ -254,20 +453,52 @@ void AAIPathNetwork::CalculatePathData(int32 beginNode)
 /// <summary>
 /// This function returns the stored path data if the begin node was already asked for before.
 /// If not asked for before it will calculate all the posible shortest paths from the begin node to each node in the network
-/// and store this in m_StoredPathData.
+/// and store this in the stored path data of the agent profile.
 /// </summary>
 /// <param name="beginNode">the node where the path data begins from</param>
+/// <param name="agentProfile">index in m_AgentProfiles</param>
 /// <returns>stored path data from the beginNode</returns>
-TArray<FAIPathData>& AAIPathNetwork::GetPathData(int32 beginNode)
+TArray<FAIPathData>& AAIPathNetwork::GetPathData(int32 beginNode, int32 agentProfile)
 {
-	if (m_StoredPathData[beginNode].Num() == m_AmountOfNodes) // means it already was calculated and stored
+	FAIPathProfileData& profileData = m_ProfileData[ToValidAgentProfile(agentProfile)];
+	if (TArray<FAIPathData>* pStoredPathData = profileData.m_StoredPathData.Find(beginNode)) // means it already was calculated and stored
 	{
-		return m_StoredPathData[beginNode];
+		return *pStoredPathData;
 	}
 
-	CalculatePathData(beginNode);
+	CalculatePathData(profileData, beginNode);
+
+	return profileData.m_StoredPathData.FindChecked(beginNode);
+}
+
+
+
+int32 AAIPathNetwork::GetAgentProfileIndex(FName profileName) const
+{
+	const int32 agentProfile = m_AgentProfiles.IndexOfByPredicate([profileName](const FAIPathAgentProfile& profile) { return profile.m_Name == profileName; });
+	return FMath::Max(agentProfile, 0);
+}
+
+
+
+EAIPathEdgeCost AAIPathNetwork::GetEdgeCost(int32 agentProfile) const
+{
+	return (m_ProfileData.Num() != 0) ? m_ProfileData[ToValidAgentProfile(agentProfile)].m_EdgeCost : EAIPathEdgeCost::SQUARED_DISTANCE;
+}
+
+
 
-	return m_StoredPathData[beginNode];
+/// <summary>
+/// Cost of moving in a straight line from fromLocation to toLocation using the edge cost of the agent profile.
+/// Penalties are not applied since there is no connection (or node terrain) between the 2 locations.
+/// </summary>
+/// <param name="fromLocation">World location the move starts at</param>
+/// <param name="toLocation">World location the move ends at</param>
+/// <param name="agentProfile">Index in m_AgentProfiles</param>
+/// <returns>The cost in the same unit as FAIPathData::m_Cost of the agent profile</returns>
+float AAIPathNetwork::GetStraightLineCost(const FVector& fromLocation, const FVector& toLocation, int32 agentProfile) const
+{
+	return (GetEdgeCost(agentProfile) == EAIPathEdgeCost::DISTANCE) ? FVector::Dist(fromLocation, toLocation) : FVector::DistSquared(fromLocation, toLocation);
 }
 
 
@@ -317,19 +548,20 @@ FAIPath AAIPathNetwork::GetPathFromTo(const TArray<FAIPathData>& pathData, int32
 	// pre checks
 	if (pathDataSize == 0)
 	{
-		LogText(ELogVerbosity::Warning, "AAIPathNetwork::GetPathFromTo Can't get path on a network of size 0");
+		LOG_TEXT(Warning, TEXT("AAIPathNetwork::GetPathFromTo Can't get path on a network of size 0"));
 		return path;
 	}
 
 	if (pathDataSize != m_AmountOfNodes)
 	{
-		LogText(ELogVerbosity::Error, "AAIPathNetwork::GetPathFromTo pathData incorrect size! This shouldnt happen!");
+		LOG_TEXT(Error, TEXT("AAIPathNetwork::GetPathFromTo pathData incorrect size! This shouldnt happen!"));
 		return path;
 	}
 
 	if (pathData[toNode].m_PreviousNodeIndex == -1)
 	{
-		LogText(ELogVerbosity::Warning, "AAIPathNetwork::GetPathFromTo cannot reach targetNode [ " + FString::FromInt(toNode) + " ]");
+		// happens once per unreachable query so it goes trough the ring buffer instead of directly to the output log
+		LOG_TEXT_RING(Warning, TEXT("AAIPathNetwork::GetPathFromTo cannot reach targetNode [ %d ]"), toNode);
 		return path;
 	}
 
@@ -351,6 +583,541 @@ FAIPath AAIPathNetwork::GetPathFromTo(const TArray<FAIPathData>& pathData, int32
 
 
 
+/// <summary>
+/// Returns the shortest path from beginNode to toNode, how the network gets searched depends on searchMode.
+/// When the paths from beginNode were already fully calculated these get used no matter the search mode.
+/// </summary>
+/// <param name="beginNode">Node index the path starts from</param>
+/// <param name="toNode">Node index of the node you want to move towards</param>
+/// <param name="searchMode">How to search the network when nothing was stored yet</param>
+/// <param name="agentProfile">Index in m_AgentProfiles, the costs and stored searches of this profile get used</param>
+/// <returns>Returns the path to traverse to get to the given toNode index</returns>
+FAIPath AAIPathNetwork::FindPath(int32 beginNode, int32 toNode, EAIPathSearchMode searchMode, int32 agentProfile)
+{
+	FAIPath path{};
+
+	if (!IsValidNodeIndex(beginNode) || !IsValidNodeIndex(toNode))
+	{
+		LOG_TEXT(Warning, TEXT("AAIPathNetwork::FindPath invalid node index [ %d ] or [ %d ]"), beginNode, toNode);
+		return path;
+	}
+
+	const int32 runtimeBeginNode = m_RuntimeGraph.ToRuntime(beginNode);
+	const int32 runtimeToNode = m_RuntimeGraph.ToRuntime(toNode);
+
+	if (!m_Components.CanReach(runtimeBeginNode, runtimeToNode))
+	{
+		LOG_TEXT_RING(Warning, TEXT("AAIPathNetwork::FindPath cannot reach targetNode [ %d ]"), toNode);
+		return path;
+	}
+
+	agentProfile = ToValidAgentProfile(agentProfile);
+	FAIPathProfileData& profileData = m_ProfileData[agentProfile];
+	if (const TArray<FAIPathData>* pStoredPathData = profileData.m_StoredPathData.Find(beginNode)) // means it already was calculated and stored
+	{
+		return GetPathFromTo(*pStoredPathData, toNode);
+	}
+
+	auto isToNode = [runtimeToNode](int32 nodeIndex) { return nodeIndex == runtimeToNode; };
+
+	switch (searchMode)
+	{
+	case EAIPathSearchMode::FULL_GRAPH:
+		return GetPathFromTo(GetPathData(beginNode, agentProfile), toNode);
+
+	case EAIPathSearchMode::EARLY_EXIT:
+	{
+		FAIPathSearch& search = GetPartialPathSearch(profileData, runtimeBeginNode);
+		if (!search.IsSettled(runtimeToNode))
+		{
+			const int32 expansionsBefore = search.m_AmountOfExpansions;
+			VisitEdgeCost(profileData, [&](const auto& cost)
+			{
+				AdvanceSearch(m_RuntimeGraph, cost, search, isToNode);
+			});
+			m_ExpansionsThisFrame += search.m_AmountOfExpansions - expansionsBefore;
+		}
+
+		path.m_bIsValid = search.BuildPath(runtimeToNode, path.m_Path);
+
+		// reached every node while looking for toNode, so it can be stored as full path data
+		if (search.IsExhausted())
+		{
+			StorePathSearch(profileData, search);
+			profileData.m_PartialPathSearches.Remove(runtimeBeginNode);
+		}
+		break;
+	}
+
+	case EAIPathSearchMode::BIDIRECTIONAL:
+		path.m_bIsValid = VisitEdgeCost(profileData, [&](const auto& cost)
+		{
+			return BidirectionalSearch(m_RuntimeGraph, cost, runtimeBeginNode, runtimeToNode, path.m_Path);
+		});
+		break;
+
+	case EAIPathSearchMode::A_STAR:
+	{
+		FAIPathSearch search{};
+		search.Reset(m_AmountOfNodes, runtimeBeginNode);
+		VisitEdgeCost(profileData, [&](const auto& cost)
+		{
+			AdvanceSearch(m_RuntimeGraph, cost, search, isToNode, MAX_int32, FAIPathLandmarkHeuristic(profileData.m_Landmarks, runtimeToNode));
+		});
+		m_ExpansionsThisFrame += search.m_AmountOfExpansions;
+		path.m_bIsValid = search.BuildPath(runtimeToNode, path.m_Path);
+		break;
+	}
+
+	case EAIPathSearchMode::WEIGHTED_A_STAR:
+	{
+		// without landmarks the heuristic is 0 and this is a plain (optimal) dijkstra
+		const TAIPathWeightedHeuristic<FAIPathLandmarkHeuristic> heuristic(FAIPathLandmarkHeuristic(profileData.m_Landmarks, runtimeToNode), 1.0f + m_CurrentSuboptimality);
+
+		FAIPathSearch search{};
+		search.Reset(m_AmountOfNodes, runtimeBeginNode);
+		VisitEdgeCost(profileData, [&](const auto& cost)
+		{
+			AdvanceSearch(m_RuntimeGraph, cost, search, isToNode, MAX_int32, heuristic);
+		});
+		m_ExpansionsThisFrame += search.m_AmountOfExpansions;
+		path.m_bIsValid = search.BuildPath(runtimeToNode, path.m_Path);
+		break;
+	}
+	}
+
+	if (!path.m_bIsValid)
+	{
+		LOG_TEXT_RING(Warning, TEXT("AAIPathNetwork::FindPath cannot reach targetNode [ %d ]"), toNode);
+	}
+
+	m_RuntimeGraph.ToAuthoring(path.m_Path);
+	return path;
+}
+
+
+
+/// <summary>
+/// Finds the closest reachable nodes out of targetNodes (cover points, pickups, ...) with a single search from beginNode.
+/// The search uses the stored early exit search from beginNode and stops as soon as enough targets are settled,
+/// every settled target is at least as close as any target that isn't settled yet.
+/// </summary>
+/// <param name="beginNode">Node index the paths start from</param>
+/// <param name="targetNodes">Node indexes of all candidate targets</param>
+/// <param name="amount">How many of the closest targets to return</param>
+/// <param name="agentProfile">Index in m_AgentProfiles, the costs and stored searches of this profile get used</param>
+/// <returns>Paths towards the closest targets ordered from closest to furthest, less than amount when not enough are reachable</returns>
+TArray<FAIPath> AAIPathNetwork::FindNearestPaths(int32 beginNode, const TArray<int32>& targetNodes, int32 amount, int32 agentProfile)
+{
+	TArray<FAIPath> paths{};
+
+	if (!IsValidNodeIndex(beginNode) || amount <= 0)
+	{
+		LOG_TEXT(Warning, TEXT("AAIPathNetwork::FindNearestPaths invalid begin node [ %d ] or amount [ %d ]"), beginNode, amount);
+		return paths;
+	}
+
+	const int32 runtimeBeginNode = m_RuntimeGraph.ToRuntime(beginNode);
+
+	// targets in other components get rejected right away, isTarget uses runtime node indexes
+	TBitArray<> isTarget(false, m_AmountOfNodes);
+	int32 amountOfTargets = 0;
+	for (int32 targetNode : targetNodes)
+	{
+		const int32 runtimeTargetNode = IsValidNodeIndex(targetNode) ? m_RuntimeGraph.ToRuntime(targetNode) : -1;
+		if (runtimeTargetNode != -1 && !isTarget[runtimeTargetNode] && m_Components.CanReach(runtimeBeginNode, runtimeTargetNode))
+		{
+			isTarget[runtimeTargetNode] = true;
+			amountOfTargets++;
+		}
+	}
+
+	if (amountOfTargets == 0)
+	{
+		return paths;
+	}
+
+	// asking for more than there are targets would otherwise never stop the search before the whole graph is settled
+	amount = FMath::Min(amount, amountOfTargets);
+
+	// already fully calculated means no search is needed
+	FAIPathProfileData& profileData = m_ProfileData[ToValidAgentProfile(agentProfile)];
+	const TArray<FAIPathData>* pStoredPathData = profileData.m_StoredPathData.Find(beginNode);
+	const bool bIsStored = pStoredPathData != nullptr;
+	FAIPathSearch* pSearch = bIsStored ? nullptr : &GetPartialPathSearch(profileData, runtimeBeginNode);
+
+	if (pSearch != nullptr)
+	{
+		// targets settled by previous queries dont have to be searched again
+		int32 amountSettled = 0;
+		for (TConstSetBitIterator<> it(isTarget); it; ++it)
+		{
+			amountSettled += pSearch->IsSettled(it.GetIndex()) ? 1 : 0;
+		}
+
+		if (amountSettled < amount)
+		{
+			VisitEdgeCost(profileData, [&](const auto& cost)
+			{
+				AdvanceSearch(m_RuntimeGraph, cost, *pSearch, [&](int32 nodeIndex)
+				{
+					return isTarget[nodeIndex] && ++amountSettled >= amount;
+				});
+			});
+		}
+	}
+
+	// <cost, runtime target node> of all reached targets
+	TArray<TPair<float, int32>> reachedTargets{};
+	for (TConstSetBitIterator<> it(isTarget); it; ++it)
+	{
+		const int32 runtimeTargetNode = it.GetIndex();
+		const int32 targetNode = m_RuntimeGraph.ToAuthoring(runtimeTargetNode);
+		if (bIsStored && (*pStoredPathData)[targetNode].m_PreviousNodeIndex != -1)
+		{
+			reachedTargets.Add(TPair<float, int32>((*pStoredPathData)[targetNode].m_Cost, runtimeTargetNode));
+		}
+		else if (!bIsStored && pSearch->IsSettled(runtimeTargetNode))
+		{
+			reachedTargets.Add(TPair<float, int32>(pSearch->m_Distances[runtimeTargetNode], runtimeTargetNode));
+		}
+	}
+
+	reachedTargets.Sort([](const TPair<float, int32>& a, const TPair<float, int32>& b) { return a.Key < b.Key; });
+
+	const int32 amountOfPaths = FMath::Min(amount, reachedTargets.Num());
+	paths.Reserve(amountOfPaths);
+	for (int32 i = 0; i < amountOfPaths; i++)
+	{
+		if (bIsStored)
+		{
+			paths.Add(GetPathFromTo(*pStoredPathData, m_RuntimeGraph.ToAuthoring(reachedTargets[i].Value)));
+		}
+		else
+		{
+			FAIPath& path = paths.AddDefaulted_GetRef();
+			path.m_bIsValid = pSearch->BuildPath(reachedTargets[i].Value, path.m_Path);
+			m_RuntimeGraph.ToAuthoring(path.m_Path);
+		}
+	}
+
+	// reached every node while looking for the targets, so it can be stored as full path data
+	if (pSearch != nullptr && pSearch->IsExhausted())
+	{
+		StorePathSearch(profileData, *pSearch);
+		profileData.m_PartialPathSearches.Remove(runtimeBeginNode);
+	}
+
+	return paths;
+}
+
+
+
+/// <summary>
+/// Checks if toNode can be reached from beginNode using the precomputed component labels.
+/// This is O(1) unless the network has so many components that the reachability table wasnt stored,
+/// then it only is O(1) for nodes in different components and searches (and stores) otherwise.
+/// </summary>
+/// <param name="fromNode">Node index the path would start from</param>
+/// <param name="toNode">Node index the path would end at</param>
+/// <returns>If there is any path from fromNode to toNode</returns>
+bool AAIPathNetwork::IsReachable(int32 fromNode, int32 toNode)
+{
+	if (!IsValidNodeIndex(fromNode) || !IsValidNodeIndex(toNode) || !m_Components.CanReach(m_RuntimeGraph.ToRuntime(fromNode), m_RuntimeGraph.ToRuntime(toNode)))
+	{
+		return false;
+	}
+
+	return m_Components.HasReachabilityTable() || FindPath(fromNode, toNode, EAIPathSearchMode::EARLY_EXIT).m_bIsValid;
+}
+
+
+
+/// <summary>
+/// Searches from beginNode (over the reverse edges when bReverse) until one of targetNodes is settled or maxExpansions is reached.
+/// Used to splice a path locally instead of searching the whole network again.
+/// </summary>
+/// <param name="beginNode">Node index the search starts from</param>
+/// <param name="targetNodes">Node indexes the search stops at, intended to be small (a few nodes of an existing path)</param>
+/// <param name="maxExpansions">Amount of nodes the search can expand before giving up</param>
+/// <param name="bReverse">Search backwards, the returned path then goes from the reached target to beginNode</param>
+/// <param name="agentProfile">Index in m_AgentProfiles, the costs of this profile get used</param>
+/// <returns>The path in walking order, invalid when no target was reached</returns>
+FAIPath AAIPathNetwork::FindLocalPath(int32 beginNode, const TArray<int32>& targetNodes, int32 maxExpansions, bool bReverse, int32 agentProfile) const
+{
+	FAIPath path{};
+	if (!IsValidNodeIndex(beginNode))
+	{
+		LOG_TEXT(Warning, TEXT("AAIPathNetwork::FindLocalPath invalid begin node [ %d ]"), beginNode);
+		return path;
+	}
+
+	const int32 runtimeBeginNode = m_RuntimeGraph.ToRuntime(beginNode);
+
+	TArray<int32> runtimeTargetNodes{};
+	for (int32 targetNode : targetNodes)
+	{
+		const int32 runtimeTargetNode = IsValidNodeIndex(targetNode) ? m_RuntimeGraph.ToRuntime(targetNode) : -1;
+		if (runtimeTargetNode != -1 && (bReverse ? m_Components.CanReach(runtimeTargetNode, runtimeBeginNode) : m_Components.CanReach(runtimeBeginNode, runtimeTargetNode)))
+		{
+			runtimeTargetNodes.Add(runtimeTargetNode);
+		}
+	}
+
+	if (runtimeTargetNodes.Num() == 0)
+	{
+		return path;
+	}
+
+	FAIPathSearch search{};
+	search.Reset(m_AmountOfNodes, runtimeBeginNode);
+
+	int32 reachedNode = -1;
+	auto onSettled = [&](int32 nodeIndex)
+	{
+		reachedNode = runtimeTargetNodes.Contains(nodeIndex) ? nodeIndex : -1;
+		return reachedNode != -1;
+	};
+
+	const EAIPathSearchStatus status = VisitEdgeCost(m_ProfileData[ToValidAgentProfile(agentProfile)], [&](const auto& cost)
+	{
+		return bReverse
+			? AdvanceSearch<true>(m_RuntimeGraph, cost, search, onSettled, maxExpansions)
+			: AdvanceSearch(m_RuntimeGraph, cost, search, onSettled, maxExpansions);
+	});
+
+	if (status != EAIPathSearchStatus::STOPPED)
+	{
+		return path;
+	}
+
+	path.m_bIsValid = search.BuildPath(reachedNode, path.m_Path);
+	m_RuntimeGraph.ToAuthoring(path.m_Path);
+	if (bReverse)
+	{
+		// the reverse search goes from beginNode back to the target, walking goes the other way around
+		Algo::Reverse(path.m_Path);
+	}
+	return path;
+}
+
+
+
+bool AAIPathNetwork::HasConnection(int32 fromNode, int32 toNode) const
+{
+	if (!IsValidNodeIndex(fromNode) || !IsValidNodeIndex(toNode))
+	{
+		return false;
+	}
+
+	const int32 runtimeFromNode = m_RuntimeGraph.ToRuntime(fromNode);
+	const int32 runtimeToNode = m_RuntimeGraph.ToRuntime(toNode);
+	for (int32 edge = m_RuntimeGraph.m_EdgeOffsets[runtimeFromNode]; edge < m_RuntimeGraph.m_EdgeOffsets[runtimeFromNode + 1]; edge++)
+	{
+		if (m_RuntimeGraph.m_EdgeTargets[edge] == runtimeToNode)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+int32 AAIPathNetwork::GetAmountOfNodes() const
+{
+	return m_AmountOfNodes;
+}
+
+
+
+/// <summary>
+/// Picks amountOfLandmarks landmark nodes (farthest point selection) and stores the distances towards and from each of them.
+/// These give the A* search mode lower bounds that work well on maze like networks, unlike a straight line distance.
+/// Each agent profile measures distance differently so each one gets its own landmarks.
+/// </summary>
+/// <param name="amountOfLandmarks">Amount of landmarks, a handful (4 - 16) is usually enough</param>
+void AAIPathNetwork::PrecomputeLandmarks(int32 amountOfLandmarks)
+{
+	for (FAIPathProfileData& profileData : m_ProfileData)
+	{
+		VisitEdgeCost(profileData, [&](const auto& cost)
+		{
+			BuildLandmarks(m_RuntimeGraph, cost, amountOfLandmarks, profileData.m_Landmarks);
+		});
+	}
+	LOG_TEXT(Log, TEXT("AAIPathNetwork::PrecomputeLandmarks picked [ %d ] landmarks for [ %d ] nodes and [ %d ] agent profiles"), FMath::Min(amountOfLandmarks, m_AmountOfNodes), m_AmountOfNodes, m_ProfileData.Num());
+}
+
+
+
+/// <summary>
+/// Queues an A* search (using the landmarks when precomputed) from beginNode to toNode that UpdateTimeSlicedSearches
+/// advances every frame within m_PathfindingBudgetMs and m_MaxExpansionsPerFrame.
+/// </summary>
+/// <param name="beginNode">Node index the path starts from</param>
+/// <param name="toNode">Node index of the node you want to move towards</param>
+/// <param name="priority">Weight of this search when dividing the budget, at least 1</param>
+/// <param name="agentProfile">Index in m_AgentProfiles, the costs and landmarks of this profile get used</param>
+/// <returns>Handle of the search, -1 when the node indexes are invalid</returns>
+int32 AAIPathNetwork::RequestTimeSlicedPath(int32 beginNode, int32 toNode, int32 priority, int32 agentProfile)
+{
+	if (!IsValidNodeIndex(beginNode) || !IsValidNodeIndex(toNode))
+	{
+		LOG_TEXT(Warning, TEXT("AAIPathNetwork::RequestTimeSlicedPath invalid node index [ %d ] or [ %d ]"), beginNode, toNode);
+		return -1;
+	}
+
+	FAIPathTimeSlicedSearch& timeSlicedSearch = m_TimeSlicedSearches.AddDefaulted_GetRef();
+	timeSlicedSearch.m_Handle = m_NextSearchHandle++;
+	timeSlicedSearch.m_ToNode = m_RuntimeGraph.ToRuntime(toNode);
+	timeSlicedSearch.m_AgentProfile = ToValidAgentProfile(agentProfile);
+	timeSlicedSearch.m_Priority = FMath::Max(priority, 1);
+
+	// unreachable searches get reported at the next update without allocating any search data
+	const int32 runtimeBeginNode = m_RuntimeGraph.ToRuntime(beginNode);
+	timeSlicedSearch.m_bIsUnreachable = !m_Components.CanReach(runtimeBeginNode, timeSlicedSearch.m_ToNode);
+	if (!timeSlicedSearch.m_bIsUnreachable)
+	{
+		timeSlicedSearch.m_Search.Reset(m_AmountOfNodes, runtimeBeginNode);
+	}
+
+	return timeSlicedSearch.m_Handle;
+}
+
+
+
+void AAIPathNetwork::CancelTimeSlicedPath(int32 searchHandle)
+{
+	m_TimeSlicedSearches.RemoveAll([searchHandle](const FAIPathTimeSlicedSearch& timeSlicedSearch) { return timeSlicedSearch.m_Handle == searchHandle; });
+}
+
+
+
+bool AAIPathNetwork::IsTimeSlicedPathPending(int32 searchHandle) const
+{
+	return m_TimeSlicedSearches.ContainsByPredicate([searchHandle](const FAIPathTimeSlicedSearch& timeSlicedSearch) { return timeSlicedSearch.m_Handle == searchHandle; });
+}
+
+
+
+/// <summary>
+/// Divides m_PathfindingBudgetMs and m_MaxExpansionsPerFrame over all pending time sliced searches by priority.
+/// Searches get handled from highest to lowest priority, each one gets its share of what is left
+/// so time not used by a search that finishes early goes to the searches after it.
+/// Finished searches get removed and reported trough m_OnTimeSlicedPathCompleted.
+/// </summary>
+void AAIPathNetwork::UpdateTimeSlicedSearches()
+{
+	if (m_TimeSlicedSearches.Num() == 0)
+	{
+		return;
+	}
+
+	m_TimeSlicedSearches.StableSort([](const FAIPathTimeSlicedSearch& a, const FAIPathTimeSlicedSearch& b) { return a.m_Priority > b.m_Priority; });
+
+	int32 priorityLeft = 0;
+	for (const FAIPathTimeSlicedSearch& timeSlicedSearch : m_TimeSlicedSearches)
+	{
+		priorityLeft += timeSlicedSearch.m_Priority;
+	}
+
+	const double frameDeadline = FPlatformTime::Seconds() + m_PathfindingBudgetMs / 1000.0;
+	int32 expansionsLeft = m_MaxExpansionsPerFrame;
+
+	// <handle, path> broadcasted after all searches are updated, so listeners can safely request new searches
+	TArray<TPair<int32, FAIPath>> completedSearches{};
+
+	for (int32 i = 0; i < m_TimeSlicedSearches.Num(); i++)
+	{
+		if (m_TimeSlicedSearches[i].m_bIsUnreachable)
+		{
+			priorityLeft -= m_TimeSlicedSearches[i].m_Priority;
+			completedSearches.Add(TPair<int32, FAIPath>(m_TimeSlicedSearches[i].m_Handle, FAIPath{}));
+			m_TimeSlicedSearches.RemoveAt(i--);
+			continue;
+		}
+
+		const double now = FPlatformTime::Seconds();
+		if (now >= frameDeadline || expansionsLeft <= 0)
+		{
+			break;
+		}
+
+		FAIPathTimeSlicedSearch& timeSlicedSearch = m_TimeSlicedSearches[i];
+		const int32 toNode = timeSlicedSearch.m_ToNode;
+		const float share = float(timeSlicedSearch.m_Priority) / float(priorityLeft);
+		priorityLeft -= timeSlicedSearch.m_Priority;
+
+		const FAIPathProfileData& profileData = m_ProfileData[timeSlicedSearch.m_AgentProfile];
+		const int32 expansionsBefore = timeSlicedSearch.m_Search.m_AmountOfExpansions;
+		const EAIPathSearchStatus status = VisitEdgeCost(profileData, [&](const auto& cost)
+		{
+			return AdvanceSearchTimeSliced(m_RuntimeGraph, cost, timeSlicedSearch.m_Search,
+				[toNode](int32 nodeIndex) { return nodeIndex == toNode; },
+				FMath::Max(FMath::CeilToInt(expansionsLeft * share), 1),
+				now + (frameDeadline - now) * share,
+				FAIPathLandmarkHeuristic(profileData.m_Landmarks, toNode));
+		});
+		expansionsLeft -= timeSlicedSearch.m_Search.m_AmountOfExpansions - expansionsBefore;
+		m_ExpansionsThisFrame += timeSlicedSearch.m_Search.m_AmountOfExpansions - expansionsBefore;
+
+		if (status == EAIPathSearchStatus::OUT_OF_BUDGET)
+		{
+			continue;
+		}
+
+		FAIPath path{};
+		path.m_bIsValid = timeSlicedSearch.m_Search.BuildPath(toNode, path.m_Path);
+		m_RuntimeGraph.ToAuthoring(path.m_Path);
+		completedSearches.Add(TPair<int32, FAIPath>(timeSlicedSearch.m_Handle, MoveTemp(path)));
+		m_TimeSlicedSearches.RemoveAt(i--);
+	}
+
+	for (const TPair<int32, FAIPath>& completedSearch : completedSearches)
+	{
+		if (!completedSearch.Value.m_bIsValid)
+		{
+			LOG_TEXT_RING(Warning, TEXT("AAIPathNetwork::UpdateTimeSlicedSearches search [ %d ] cannot reach its targetNode"), completedSearch.Key);
+		}
+		m_OnTimeSlicedPathCompleted.Broadcast(completedSearch.Key, completedSearch.Value);
+	}
+}
+
+
+
+float AAIPathNetwork::GetCurrentSuboptimality() const
+{
+	return m_CurrentSuboptimality;
+}
+
+
+
+/// <summary>
+/// Moves the epsilon of the weighted A* search mode towards what the current load asks for.
+/// The load is the highest of how far the frame time goes over m_TargetFrameTimeMs and
+/// how many nodes got expanded since the last update compared to m_MaxExpansionsPerFrame.
+/// Only the weight changes, so every path stays within (1 + epsilon) of the shortest no matter the load.
+/// Uses the real frame time instead of the game delta time, which is scaled by time dilation and clamped by the engine.
+/// </summary>
+void AAIPathNetwork::UpdateSuboptimality()
+{
+	// the properties are BlueprintReadWrite and ClampMin only applies in the editor, a negative epsilon (weight below 1) or NaN would break the (1 + epsilon) bound
+	const float targetFrameTimeMs = FMath::Max(m_TargetFrameTimeMs, 1.0f);
+	const float maxSuboptimality = FMath::Max(m_MaxSuboptimality, 0.0f);
+	const float minSuboptimality = FMath::Clamp(m_MinSuboptimality, 0.0f, maxSuboptimality);
+
+	const float deltaTime = float(FApp::GetDeltaTime());
+	const float frameLoad = FMath::Clamp((deltaTime * 1000.0f - targetFrameTimeMs) / targetFrameTimeMs, 0.0f, 1.0f);
+	const float expansionLoad = FMath::Clamp(float(m_ExpansionsThisFrame) / float(FMath::Max(m_MaxExpansionsPerFrame, 1)), 0.0f, 1.0f);
+	m_ExpansionsThisFrame = 0;
+
+	const float targetSuboptimality = FMath::Lerp(minSuboptimality, maxSuboptimality, FMath::Max(frameLoad, expansionLoad));
+	m_CurrentSuboptimality = FMath::Clamp(FMath::FInterpTo(m_CurrentSuboptimality, targetSuboptimality, deltaTime, m_SuboptimalityInterpSpeed), minSuboptimality, maxSuboptimality);
+}
+
+
+
 /// <summary>
 /// Calculates the closest node in this node network from the given vector "Location".
 /// </summary>
@@ -393,35 +1160,28 @@ FAIPathNode::FAIPathNode()
 void FAIPathNode::Initialize()
 {
 	check(m_pNetworkReference != nullptr);
-	CalculateSquareDistances();
+	ValidateConnectedNodeIndexes();
 }
 
 /// <summary>
-/// This function calculates all the squared distances towards all connected nodes of this node.
+/// Makes sure all connected node indexes point to an existing node, the edge weights themselves
+/// get computed for all nodes at once in AAIPathNetwork::BuildRuntimeGraph.
 /// </summary>
-void FAIPathNode::CalculateSquareDistances()
+void FAIPathNode::ValidateConnectedNodeIndexes()
 {
 	if (m_pNetworkReference == nullptr)
-		return LogText(ELogVerbosity::Warning, L"FAIPathNode::CalculateSquareDistances Network reference was nullptr!");
-
-	// makes sure the vector is empty to then fill it with the squared distances to each connected node
-	m_ConnectedSquaredDistances.Empty();
-	int32 nrOfConnectedNodes = m_ConnectedNodeIndexes.Num();
-	int32 nrOfNodes = m_pNetworkReference->m_NodeContainer.Num();
+	{
+		LOG_TEXT(Warning, TEXT("FAIPathNode::ValidateConnectedNodeIndexes Network reference was nullptr!"));
+		return;
+	}
 
-	m_ConnectedSquaredDistances.Reserve(nrOfConnectedNodes);
-	for (int32 i = 0; i < nrOfConnectedNodes; i++)
+	for (int32& connectedNodeIndex : m_ConnectedNodeIndexes)
 	{
-		if (m_ConnectedNodeIndexes[i] >= nrOfNodes)
+		if (!IsValidIndex(connectedNodeIndex, m_pNetworkReference->m_NodeContainer))
 		{
 			check(false);
-			LogText(ELogVerbosity::Error, "FAIPathNode::CalculateSquareDistances invalid connected node index[ " + FString::FromInt(m_ConnectedNodeIndexes[i]) + " ] setting it to 0");
-			m_ConnectedNodeIndexes[i] = 0;
-		}
-		else
-		{
-			FAIPathNode& other = m_pNetworkReference->m_NodeContainer[m_ConnectedNodeIndexes[i]];
-			m_ConnectedSquaredDistances.Add(FVector::DistSquared(this->m_Location, other.m_Location));
+			LOG_TEXT(Error, TEXT("FAIPathNode::ValidateConnectedNodeIndexes invalid connected node index[ %d ] setting it to 0"), connectedNodeIndex);
+			connectedNodeIndex = 0;
 		}
 	}
 }
@@ -443,20 +1203,27 @@ void FAIPathNode::SetNetworkReference(AAIPathNetwork* pNetworkRef)
 	}
 	// the given pointer shouldn't be a nullptr
 	check(false);
-	return LogText(ELogVerbosity::Warning, "FAIPathNode::SetNetworkReference the given network reference was nullptr!");
+	LOG_TEXT(Warning, TEXT("FAIPathNode::SetNetworkReference the given network reference was nullptr!"));
 }
 
 
 
 /// <summary>
-/// Returns the calculated squared distances using the given node index.
+/// Returns the squared distance towards the connected node at the given index of m_ConnectedNodeIndexes.
 /// Returns float max when invalid node.
 /// </summary>
-/// <param name="nodeIndex">Other node index to get distance to from</param>
-/// <returns>Squared distance towards nodeIndex from self</returns>
+/// <param name="nodeIndex">Index in m_ConnectedNodeIndexes of the other node</param>
+/// <returns>Squared distance towards the connected node from self</returns>
 float FAIPathNode::GetConnectedNodeWeight(int32 nodeIndex) const
 {
-	return IsValidIndex(nodeIndex, m_ConnectedSquaredDistances) ? m_ConnectedSquaredDistances[nodeIndex] : FLT_MAX;
+	if (m_pNetworkReference == nullptr || !IsValidIndex(nodeIndex, m_ConnectedNodeIndexes))
+	{
+		return FLT_MAX;
+	}
+
+	const int32 otherIndex = m_ConnectedNodeIndexes[nodeIndex];
+	const TArray<FAIPathNode>& nodes = m_pNetworkReference->m_NodeContainer;
+	return IsValidIndex(otherIndex, nodes) ? FVector::DistSquared(m_Location, nodes[otherIndex].m_Location) : FLT_MAX;
 }
 
 //
@@ -471,8 +1238,8 @@ FAIPath::FAIPath()
 // AIPathData
 //
 
-FAIPathData::FAIPathData(float dist, int32 prevNode)
-	: m_SquaredDistance{ dist }
+FAIPathData::FAIPathData(float cost, int32 prevNode)
+	: m_Cost{ cost }
 	, m_PreviousNodeIndex{ prevNode }
 {
 }
@@ -1,17 +1,69 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "AIPathGraph.h"
 #include "AIPathNetwork.generated.h"
 
+// how a single target path query searches the network
+UENUM(BlueprintType)
+enum class EAIPathSearchMode : uint8
+{
+	FULL_GRAPH = 0 UMETA(DisplayName = "Full Graph"),		// paths towards all nodes get calculated and stored (GetPathData)
+	EARLY_EXIT = 1 UMETA(DisplayName = "Early Exit"),		// stops once the target is reached, the search gets stored and resumed by later queries
+	BIDIRECTIONAL = 2 UMETA(DisplayName = "Bidirectional"),	// searches from both ends at once, nothing gets stored
+	A_STAR = 3 UMETA(DisplayName = "A* (Landmarks)"),		// goal directed using the landmark distances, nothing gets stored
+	WEIGHTED_A_STAR = 4 UMETA(DisplayName = "Weighted A* (Landmarks)")	// like A_STAR but the path can be up to (1 + GetCurrentSuboptimality()) times longer, expands less nodes under load
+};
+
+// how the nodes get renumbered in the runtime graph, all node indexes outside of the network stay the m_NodeContainer indexes
+UENUM(BlueprintType)
+enum class EAIPathNodeOrdering : uint8
+{
+	AUTHORING = 0 UMETA(DisplayName = "Authoring"),					// same order as m_NodeContainer
+	BREADTH_FIRST = 1 UMETA(DisplayName = "Breadth First (Cuthill-McKee)"),	// connected nodes close to each other
+	HILBERT_CURVE = 2 UMETA(DisplayName = "Hilbert Curve")				// nodes close to each other in the level close to each other
+};
+
+// what the cost of moving over a connection is based on, before any penalties of the agent profile
+UENUM(BlueprintType)
+enum class EAIPathEdgeCost : uint8
+{
+	SQUARED_DISTANCE = 0 UMETA(DisplayName = "Squared Distance"),	// prefers many short connections over a few long ones
+	DISTANCE = 1 UMETA(DisplayName = "Distance")					// true shortest paths
+};
+
+// how a type of agent (infantry, vehicle, ...) values the connections of the network
+// every profile has its own stored path data, searches and landmarks
+USTRUCT(BlueprintType)
+struct FAIPathAgentProfile
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathNetwork", Meta = (DisplayName = "Name"))
+		FName m_Name;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathNetwork", Meta = (DisplayName = "Edge Cost"))
+		EAIPathEdgeCost m_EdgeCost = EAIPathEdgeCost::SQUARED_DISTANCE;
+
+	// use the ConnectionCostMultipliers of the nodes
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathNetwork", Meta = (DisplayName = "Use Connection Multipliers"))
+		bool m_bUseConnectionMultipliers = true;
+
+	// cost multiplier for entering a node, index is the TerrainType of that node (missing terrain types count as 1)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathNetwork", Meta = (DisplayName = "Terrain Penalties", ClampMin = "0.01"))
+		TArray<float> m_TerrainPenalties;
+};
+
 USTRUCT(BlueprintType)
 struct FAIPathData
 {
 	GENERATED_BODY()
 
-	FAIPathData(float dist = 0.0f, int32 prevNode = -1);
+	FAIPathData(float cost = 0.0f, int32 prevNode = -1);
 
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AIPathNetwork", Meta = (DisplayName = "squared Distance"))
-		float m_SquaredDistance;
+	// cost of the path towards this node, the unit depends on the EAIPathEdgeCost (and penalties) of the agent profile
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AIPathNetwork", Meta = (DisplayName = "cost"))
+		float m_Cost;
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AIPathNetwork", Meta = (DisplayName = "previous Node Index"))
 		int32 m_PreviousNodeIndex;
 };
@@ -31,6 +83,19 @@ struct FAIPathNode
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathNetwork", Meta = (DisplayName = "ConnectedNodeIndexes"))
 		TArray<int32> m_ConnectedNodeIndexes;
 
+	// !!!index 0 of this array is same as 0 of m_ConnectedNodeIndexes!!!
+	// designer cost multiplier for each connection, missing entries count as 1
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathNetwork", Meta = (DisplayName = "ConnectionCostMultipliers", ClampMin = "0.01"))
+		TArray<float> m_ConnectionCostMultipliers;
+
+	// index in FAIPathAgentProfile::m_TerrainPenalties
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathNetwork", Meta = (DisplayName = "TerrainType", ClampMin = "0"))
+		int32 m_TerrainType = 0;
+
+	// portal nodes get stitched to portal nodes of other networks (UAIPathWorldSubsystem), for example at a sublevel border
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathNetwork", Meta = (DisplayName = "IsPortal"))
+		bool m_bIsPortal = false;
+
 	void Initialize();
 
 	void SetNetworkReference(class AAIPathNetwork* pNetworkRef);
@@ -41,11 +106,7 @@ private:
 	// used to get m_NodeContainer;
 	class AAIPathNetwork* m_pNetworkReference = nullptr;
 
-	// !!!index 0 of this array is same as 0 of m_ConnectedNodeIndexes!!!
-	// this is the squaredDistance from self(x) to an other node in AAIPathNetwork::m_NodeContainer[m_ConnectedNodeIndexes[x]]
-	TArray<float> m_ConnectedSquaredDistances;
-
-	void CalculateSquareDistances();
+	void ValidateConnectedNodeIndexes();
 };
 
 USTRUCT(BlueprintType)
@@ -62,6 +123,42 @@ struct FAIPath
 		TArray<int32> m_Path;
 };
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnAIPathSearchCompleted, int32, searchHandle, const FAIPath&, path);
+
+// everything of one agent profile that depends on the edge costs, the caches of different profiles never mix
+struct FAIPathProfileData
+{
+	EAIPathEdgeCost m_EdgeCost = EAIPathEdgeCost::SQUARED_DISTANCE;
+
+	// connection multiplier * terrain penalty per runtime edge, empty when every edge has penalty 1
+	TArray<float> m_EdgePenalties;
+
+	// storing the distance and the previous node towards current node
+	// <current node, <distance, previous node towards current node>>
+	// if "previous node towards current node" = -1 means its an imposible path!
+	// only begin nodes that were asked for have an entry, see AAIPathNetwork::StorePathSearch for why references to the entries stay valid
+	TMap<int32, TArray<FAIPathData>> m_StoredPathData; // TMAP is unreals version of std::unordered_map
+
+	// searches that were stopped early (EARLY_EXIT), resumed by later queries from the same begin node
+	// once a search has reached all nodes it gets moved into m_StoredPathData
+	// !!!these use runtime node indexes (m_RuntimeGraph) for both the key and the search data!!!
+	TMap<int32, FAIPathSearch> m_PartialPathSearches;
+
+	// empty when no landmarks were precomputed
+	FAIPathLandmarks m_Landmarks;
+};
+
+// a search requested trough AAIPathNetwork::RequestTimeSlicedPath, advanced a bit every frame
+struct FAIPathTimeSlicedSearch
+{
+	int32 m_Handle = -1;
+	int32 m_ToNode = -1; // runtime node index, same as the search
+	int32 m_AgentProfile = 0;
+	int32 m_Priority = 1;
+	bool m_bIsUnreachable = false;
+	FAIPathSearch m_Search;
+};
+
 UCLASS()
 class SANKARI_API AAIPathNetwork : public AActor
 {
@@ -70,10 +167,58 @@ class SANKARI_API AAIPathNetwork : public AActor
 public:	
 	AAIPathNetwork();
 
+	virtual void Tick(float DeltaTime) override;
+
 	//contains all path nodes and can only be edited in the scene
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AIPathNetwork", Meta = (DisplayName = "Nodes"))
 		TArray<FAIPathNode> m_NodeContainer;
 
+	// every agent profile gets its own path cache, when empty there is one default profile (squared distance, no penalties)
+	// all functions taking an agentProfile use the index in this array
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AIPathNetwork", Meta = (DisplayName = "Agent Profiles"))
+		TArray<FAIPathAgentProfile> m_AgentProfiles;
+
+	// renumbering of the nodes in the runtime graph so searches jump around less in memory, mostly useful on big networks
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AIPathNetwork", Meta = (DisplayName = "Runtime Node Ordering"))
+		EAIPathNodeOrdering m_RuntimeNodeOrdering = EAIPathNodeOrdering::AUTHORING;
+
+	// amount of landmarks precomputed at BeginPlay for the A* search mode, 0 disables it (A* then behaves like dijkstra)
+	// costs 2 full searches per landmark at BeginPlay and 2 floats per landmark per node of memory
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AIPathNetwork", Meta = (DisplayName = "Amount Of Landmarks", ClampMin = "0"))
+		int32 m_AmountOfLandmarks = 0;
+
+	// portal nodes of other networks within this distance get connected to the portal nodes of this network
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AIPathNetwork", Meta = (DisplayName = "Portal Stitch Distance", ClampMin = "0.0"))
+		float m_PortalStitchDistance = 100.0f;
+
+	// time all time sliced searches together can take each frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathNetwork", Meta = (DisplayName = "Pathfinding Budget (ms)", ClampMin = "0.0"))
+		float m_PathfindingBudgetMs = 1.0f;
+
+	// amount of nodes all time sliced searches together can expand each frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathNetwork", Meta = (DisplayName = "Max Expansions Per Frame", ClampMin = "1"))
+		int32 m_MaxExpansionsPerFrame = 4096;
+
+	// called when a time sliced search finishes, also when no path was found
+	UPROPERTY(BlueprintAssignable, Category = "AIPathNetwork")
+		FOnAIPathSearchCompleted m_OnTimeSlicedPathCompleted;
+
+	// bounds of the suboptimality (epsilon) of the weighted A* search mode, paths are at most (1 + epsilon) times the shortest
+	// epsilon moves from min to max as the frame time and the amount of expanded nodes per frame go up
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathNetwork", Meta = (DisplayName = "Min Suboptimality", ClampMin = "0.0"))
+		float m_MinSuboptimality = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathNetwork", Meta = (DisplayName = "Max Suboptimality", ClampMin = "0.0"))
+		float m_MaxSuboptimality = 0.5f;
+
+	// frame time above which the load is considered too high, at twice this frame time epsilon reaches its max
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathNetwork", Meta = (DisplayName = "Target Frame Time (ms)", ClampMin = "1.0"))
+		float m_TargetFrameTimeMs = 16.6f;
+
+	// how fast epsilon follows the load, higher reacts faster but jumps around more
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AIPathNetwork", Meta = (DisplayName = "Suboptimality Interp Speed", ClampMin = "0.0"))
+		float m_SuboptimalityInterpSpeed = 4.0f;
+
 #pragma region DebugVariables
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug_AIPathNetwork", Meta = (DisplayName = "Line Width"))
@@ -102,16 +247,75 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "AIPathNetwork")
 		int32 LocationToNodeIndex(const FVector& location) const;
 
+	// index in m_AgentProfiles of the profile with the given name, 0 when there is none
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "AIPathNetwork")
+		int32 GetAgentProfileIndex(FName profileName) const;
+
+	// what the path costs of the agent profile are based on
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "AIPathNetwork")
+		EAIPathEdgeCost GetEdgeCost(int32 agentProfile = 0) const;
+
+	// cost of moving in a straight line between 2 world locations, in the same unit as the path costs of the agent profile (without penalties)
+	// used to connect networks trough their portals (UAIPathWorldSubsystem)
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "AIPathNetwork")
+		float GetStraightLineCost(const FVector& fromLocation, const FVector& toLocation, int32 agentProfile = 0) const;
+
 	// not const due to if not cached it will have to calculate the path and store it
 	UFUNCTION(BlueprintCallable, Category = "AIPathNetwork")
-		TArray<FAIPathData>& GetPathData(int32 beginNode);
+		TArray<FAIPathData>& GetPathData(int32 beginNode, int32 agentProfile = 0);
 
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "AIPathNetwork")
 		FAIPath GetPathFromTo(const TArray<FAIPathData>& pathData, int32 toNode) const;
 
+	// not const due to the search (or partial search) being stored depending on the search mode
+	UFUNCTION(BlueprintCallable, Category = "AIPathNetwork")
+		FAIPath FindPath(int32 beginNode, int32 toNode, EAIPathSearchMode searchMode = EAIPathSearchMode::EARLY_EXIT, int32 agentProfile = 0);
+
+	// returns the paths towards the closest "amount" reachable nodes out of targetNodes, ordered from closest to furthest
+	UFUNCTION(BlueprintCallable, Category = "AIPathNetwork")
+		TArray<FAIPath> FindNearestPaths(int32 beginNode, const TArray<int32>& targetNodes, int32 amount = 1, int32 agentProfile = 0);
+
+	// O(1) check using the component labels computed in Initialize
+	// not const because with very many components it can fall back on a (stored) search
+	UFUNCTION(BlueprintCallable, Category = "AIPathNetwork")
+		bool IsReachable(int32 fromNode, int32 toNode);
+
+	// bounded search for local path repairs (UAIPathCorridorComponent), nothing gets stored
+	// returns the path from beginNode to the closest of targetNodes, or from the closest of targetNodes to beginNode when bReverse
+	// invalid when none of targetNodes is reached within maxExpansions
+	UFUNCTION(BlueprintCallable, Category = "AIPathNetwork")
+		FAIPath FindLocalPath(int32 beginNode, const TArray<int32>& targetNodes, int32 maxExpansions, bool bReverse = false, int32 agentProfile = 0) const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "AIPathNetwork")
+		bool HasConnection(int32 fromNode, int32 toNode) const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "AIPathNetwork")
+		int32 GetAmountOfNodes() const;
+
+	// picks landmark nodes and stores the distances towards and from them for every agent profile, used by the A* search mode
+	UFUNCTION(BlueprintCallable, Category = "AIPathNetwork")
+		void PrecomputeLandmarks(int32 amountOfLandmarks);
+
+	// starts a search that gets spread over multiple frames, higher priority searches get a bigger part of the budget
+	// returns the handle passed to m_OnTimeSlicedPathCompleted, -1 when the node indexes are invalid
+	UFUNCTION(BlueprintCallable, Category = "AIPathNetwork")
+		int32 RequestTimeSlicedPath(int32 beginNode, int32 toNode, int32 priority = 1, int32 agentProfile = 0);
+
+	UFUNCTION(BlueprintCallable, Category = "AIPathNetwork")
+		void CancelTimeSlicedPath(int32 searchHandle);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "AIPathNetwork")
+		bool IsTimeSlicedPathPending(int32 searchHandle) const;
+
+	// epsilon currently used by the weighted A* search mode, between m_MinSuboptimality and m_MaxSuboptimality
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "AIPathNetwork")
+		float GetCurrentSuboptimality() const;
+
 protected:
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void OnConstruction(const FTransform& Transform) override;
 
 	UFUNCTION()
@@ -135,14 +339,40 @@ private:
 	void Initialize();
 	void InitializeNodes();
 	void InitializeStoredPathData();
+	void BuildRuntimeGraph();
+	void BuildProfileData();
 
 	// helper functions
-	void CalculatePathData(int32 beginNode);
+	bool IsValidNodeIndex(int32 nodeIndex) const;
+	int32 ToValidAgentProfile(int32 agentProfile) const;
+	void CalculatePathData(FAIPathProfileData& profileData, int32 beginNode);
+	FAIPathSearch& GetPartialPathSearch(FAIPathProfileData& profileData, int32 beginNode);
+	void StorePathSearch(FAIPathProfileData& profileData, const FAIPathSearch& search);
+	void UpdateTimeSlicedSearches();
+	void UpdateSuboptimality();
 
-	// storing the distance and the previous node towards current node
-	// <current node, <distanceSquared, previous node towards current node>>
-	// if "previous node towards current node" = -1 means its an imposible path!
-	TMap<int32, TArray<FAIPathData>> m_StoredPathData; // TMAP is unreals version of std::unordered_map
+	// calls function with the cost policy of the profile, so every policy gets its own instantiation of the search functions
+	template<typename TFunction>
+	auto VisitEdgeCost(const FAIPathProfileData& profileData, TFunction&& function) const;
+
+	// flat version of m_NodeContainer used by the search functions
+	// everything derived from it (components, landmarks, searches) uses its runtime node indexes
+	FAIPathGraph m_RuntimeGraph;
+
+	// strongly / weakly connected component labels of m_RuntimeGraph, rebuilt together with it
+	// the same for every agent profile since penalties never remove a connection
+	FAIPathComponents m_Components;
+
+	// one per m_AgentProfiles (at least one), only resized in Initialize so references into it stay valid
+	TArray<FAIPathProfileData> m_ProfileData;
+
+	TArray<FAIPathTimeSlicedSearch> m_TimeSlicedSearches;
+	int32 m_NextSearchHandle = 0;
+
+	float m_CurrentSuboptimality = 0.0f;
+
+	// nodes expanded by early exit, A* and time sliced searches since the last UpdateSuboptimality
+	int32 m_ExpansionsThisFrame = 0;
 
 	int32 m_AmountOfNodes = 0;
 };
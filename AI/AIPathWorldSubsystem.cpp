@@ -0,0 +1,455 @@
+#include "AIPathWorldSubsystem.h"
+#include "AIPathNetwork.h"
+#include "Algo/Reverse.h"
+#include "../Helpers.h"
+
+//
+// AIPathWorldSubsystem
+//
+
+void UAIPathWorldSubsystem::Deinitialize()
+{
+	m_Slots.Empty();
+	m_Portals.Empty();
+	m_FreePortals.Empty();
+	m_PortalSearches.Empty();
+
+	Super::Deinitialize();
+}
+
+
+
+/// <summary>
+/// Adds all portal nodes of the network to the world graph, connects the portals inside of the network with each other
+/// and stitches them to nearby portals of already registered networks.
+/// Intended to be called at BeginPlay of the network (also when its sublevel streams in).
+/// </summary>
+/// <param name="pNetwork">The network to add, needs to be initialized already</param>
+void UAIPathWorldSubsystem::RegisterNetwork(AAIPathNetwork* pNetwork)
+{
+	if (pNetwork == nullptr || FindSlot(pNetwork) != -1)
+	{
+		return;
+	}
+
+	int32 slot = m_Slots.IndexOfByPredicate([](const FNetworkSlot& networkSlot) { return !networkSlot.m_pNetwork.IsValid() && networkSlot.m_Portals.Num() == 0; });
+	if (slot == INDEX_NONE)
+	{
+		slot = m_Slots.AddDefaulted();
+	}
+	m_Slots[slot].m_pNetwork = pNetwork;
+
+	// the world graph adds up costs of different networks, so these have to use the same unit to find the shortest world paths
+	for (const FNetworkSlot& networkSlot : m_Slots)
+	{
+		if (networkSlot.m_pNetwork.IsValid() && networkSlot.m_pNetwork->GetEdgeCost() != pNetwork->GetEdgeCost())
+		{
+			LOG_TEXT(Warning, TEXT("UAIPathWorldSubsystem::RegisterNetwork [ %s ] uses a different edge cost than [ %s ] (agent profile 0), world paths between them may not be the shortest"),
+				*pNetwork->GetName(), *networkSlot.m_pNetwork->GetName());
+			break;
+		}
+	}
+
+	const FVector networkLocation = pNetwork->GetActorLocation();
+	const int32 amountOfNodes = pNetwork->m_NodeContainer.Num();
+	for (int32 i = 0; i < amountOfNodes; i++)
+	{
+		if (pNetwork->m_NodeContainer[i].m_bIsPortal)
+		{
+			m_Slots[slot].m_Portals.Add(AddPortal(slot, i, networkLocation + pNetwork->m_NodeContainer[i].m_Location));
+		}
+	}
+
+	// portals inside of the same network are connected by the shortest path between them
+	for (int32 portal : m_Slots[slot].m_Portals)
+	{
+		const TArray<FAIPathData>& pathData = pNetwork->GetPathData(m_Portals[portal].m_NodeIndex);
+		for (int32 otherPortal : m_Slots[slot].m_Portals)
+		{
+			const FAIPathData& otherPathData = pathData[m_Portals[otherPortal].m_NodeIndex];
+			if (otherPortal != portal && otherPathData.m_PreviousNodeIndex != -1)
+			{
+				m_Portals[portal].m_Edges.Add(FPortalEdge{ otherPortal, otherPathData.m_Cost });
+			}
+		}
+	}
+
+	for (int32 portal : m_Slots[slot].m_Portals)
+	{
+		StitchPortal(portal, pNetwork->m_PortalStitchDistance);
+	}
+}
+
+
+
+/// <summary>
+/// Removes all portals of the network and the stored searches that went trough it, all other networks stay as they are.
+/// Intended to be called at EndPlay of the network (also when its sublevel streams out).
+/// </summary>
+/// <param name="pNetwork">The network to remove</param>
+void UAIPathWorldSubsystem::UnregisterNetwork(AAIPathNetwork* pNetwork)
+{
+	const int32 slot = FindSlot(pNetwork);
+	if (slot == -1)
+	{
+		return;
+	}
+
+	for (int32 portal : m_Slots[slot].m_Portals)
+	{
+		// stitches are always both ways, so only the portals we are stitched to have edges towards us
+		for (const FPortalEdge& edge : m_Portals[portal].m_Edges)
+		{
+			if (m_Portals[edge.m_Portal].m_Slot != slot)
+			{
+				m_Portals[edge.m_Portal].m_Edges.RemoveAllSwap([portal](const FPortalEdge& otherEdge) { return otherEdge.m_Portal == portal; });
+			}
+		}
+	}
+
+	for (int32 portal : m_Slots[slot].m_Portals)
+	{
+		m_Portals[portal] = FPortal{};
+		m_FreePortals.Add(portal);
+	}
+
+	InvalidatePortalSearches([slot](const FPortalSearch& search)
+	{
+		return search.m_TouchedSlots.IsValidIndex(slot) && search.m_TouchedSlots[slot];
+	});
+
+	m_Slots[slot] = FNetworkSlot{};
+}
+
+
+
+/// <summary>
+/// Finds the shortest path between 2 nodes that can be in different networks.
+/// The path goes from beginNode to a portal of the begin network, over the portal graph, and from a portal of the end network to endNode.
+/// When both nodes are in the same network the path without leaving the network is also considered.
+/// </summary>
+/// <param name="pBeginNetwork">Network beginNode is part of</param>
+/// <param name="beginNode">Node index the path starts from</param>
+/// <param name="pEndNetwork">Network endNode is part of</param>
+/// <param name="endNode">Node index of the node you want to move towards</param>
+/// <returns>The path to traverse, each node together with its network</returns>
+FAIPathWorldPath UAIPathWorldSubsystem::FindWorldPath(AAIPathNetwork* pBeginNetwork, int32 beginNode, AAIPathNetwork* pEndNetwork, int32 endNode)
+{
+	FAIPathWorldPath path{};
+
+	const int32 beginSlot = FindSlot(pBeginNetwork);
+	const int32 endSlot = FindSlot(pEndNetwork);
+	if (beginSlot == -1 || endSlot == -1 || !IsValidIndex(beginNode, pBeginNetwork->m_NodeContainer) || !IsValidIndex(endNode, pEndNetwork->m_NodeContainer))
+	{
+		LOG_TEXT(Warning, TEXT("UAIPathWorldSubsystem::FindWorldPath unregistered network or invalid node index [ %d ] or [ %d ]"), beginNode, endNode);
+		return path;
+	}
+
+	float bestDistance = FLT_MAX;
+	int32 bestPortal = -1; // -1 means not leaving the begin network
+
+	if (beginSlot == endSlot)
+	{
+		const FAIPathData& directPathData = pBeginNetwork->GetPathData(beginNode)[endNode];
+		if (directPathData.m_PreviousNodeIndex != -1)
+		{
+			bestDistance = directPathData.m_Cost;
+		}
+	}
+
+	const FPortalSearch& search = GetPortalSearch(beginSlot, beginNode);
+	for (int32 portal : m_Slots[endSlot].m_Portals)
+	{
+		if (!IsValidIndex(portal, search.m_Distances) || search.m_Distances[portal] == FLT_MAX)
+		{
+			continue;
+		}
+
+		const FAIPathData& lastPathData = pEndNetwork->GetPathData(m_Portals[portal].m_NodeIndex)[endNode];
+		const float distance = search.m_Distances[portal] + lastPathData.m_Cost;
+		if (lastPathData.m_PreviousNodeIndex != -1 && distance < bestDistance)
+		{
+			bestDistance = distance;
+			bestPortal = portal;
+		}
+	}
+
+	if (bestDistance == FLT_MAX)
+	{
+		LOG_TEXT_RING(Warning, TEXT("UAIPathWorldSubsystem::FindWorldPath cannot reach targetNode [ %d ]"), endNode);
+		return path;
+	}
+
+	if (bestPortal == -1)
+	{
+		path.m_bIsValid = AppendLocalPath(beginSlot, beginNode, endNode, false, path);
+		return path;
+	}
+
+	TArray<int32> portalChain{};
+	for (int32 portal = bestPortal; portal != -1; portal = search.m_PreviousPortals[portal])
+	{
+		portalChain.Add(portal);
+	}
+	Algo::Reverse(portalChain);
+
+	bool bIsValid = AppendLocalPath(beginSlot, beginNode, m_Portals[portalChain[0]].m_NodeIndex, false, path);
+	for (int32 i = 1; i < portalChain.Num() && bIsValid; i++)
+	{
+		const FPortal& fromPortal = m_Portals[portalChain[i - 1]];
+		const FPortal& toPortal = m_Portals[portalChain[i]];
+
+		if (fromPortal.m_Slot == toPortal.m_Slot)
+		{
+			bIsValid = AppendLocalPath(toPortal.m_Slot, fromPortal.m_NodeIndex, toPortal.m_NodeIndex, true, path);
+		}
+		else
+		{
+			// stitched portals, stepping over into the other network
+			path.m_Path.Add(FAIPathWorldNode(m_Slots[toPortal.m_Slot].m_pNetwork.Get(), toPortal.m_NodeIndex));
+		}
+	}
+
+	if (bIsValid)
+	{
+		bIsValid = AppendLocalPath(endSlot, m_Portals[bestPortal].m_NodeIndex, endNode, true, path);
+	}
+
+	path.m_bIsValid = bIsValid;
+	return path;
+}
+
+
+
+/// <summary>
+/// Calculates the closest node out of all registered networks from the given vector "Location".
+/// </summary>
+/// <param name="location">Worldposition of an object</param>
+/// <returns>The closest node together with its network, nullptr network when no network has nodes</returns>
+FAIPathWorldNode UAIPathWorldSubsystem::LocationToWorldNode(const FVector& location) const
+{
+	FAIPathWorldNode closestNode{};
+	float distanceSquared = FLT_MAX;
+
+	for (const FNetworkSlot& networkSlot : m_Slots)
+	{
+		AAIPathNetwork* pNetwork = networkSlot.m_pNetwork.Get();
+		if (pNetwork == nullptr || pNetwork->m_NodeContainer.Num() == 0)
+		{
+			continue;
+		}
+
+		const int32 nodeIndex = pNetwork->LocationToNodeIndex(location);
+		const float sqDistCalc = FVector::DistSquared(pNetwork->GetActorLocation() + pNetwork->m_NodeContainer[nodeIndex].m_Location, location);
+		if (sqDistCalc < distanceSquared)
+		{
+			closestNode = FAIPathWorldNode(pNetwork, nodeIndex);
+			distanceSquared = sqDistCalc;
+		}
+	}
+
+	return closestNode;
+}
+
+
+
+// helper functions
+
+int32 UAIPathWorldSubsystem::FindSlot(const AAIPathNetwork* pNetwork) const
+{
+	if (pNetwork == nullptr)
+	{
+		return -1;
+	}
+
+	const int32 slot = m_Slots.IndexOfByPredicate([pNetwork](const FNetworkSlot& networkSlot) { return networkSlot.m_pNetwork.Get() == pNetwork; });
+	return (slot == INDEX_NONE) ? -1 : slot;
+}
+
+
+
+/// <summary>
+/// Adds a portal without any edges, reusing the portal of an unloaded network when possible.
+/// </summary>
+/// <returns>Index of the portal in m_Portals</returns>
+int32 UAIPathWorldSubsystem::AddPortal(int32 slot, int32 nodeIndex, const FVector& location)
+{
+	const int32 portal = (m_FreePortals.Num() != 0) ? m_FreePortals.Pop(false) : m_Portals.AddDefaulted();
+
+	m_Portals[portal].m_Slot = slot;
+	m_Portals[portal].m_NodeIndex = nodeIndex;
+	m_Portals[portal].m_Location = location;
+	m_Portals[portal].m_Edges.Reset();
+	return portal;
+}
+
+
+
+/// <summary>
+/// Connects the portal both ways with every portal of an other network that is within stitch distance.
+/// Stored searches that reached the other portal could now have a shorter path so these get removed,
+/// searches that didnt reach it cant reach the new network trough this stitch either.
+/// </summary>
+/// <param name="portal">Index of the portal in m_Portals</param>
+/// <param name="stitchDistance">Stitch distance of the network the portal is part of</param>
+void UAIPathWorldSubsystem::StitchPortal(int32 portal, float stitchDistance)
+{
+	const AAIPathNetwork* pNetwork = m_Slots[m_Portals[portal].m_Slot].m_pNetwork.Get();
+	const int32 amountOfPortals = m_Portals.Num();
+	for (int32 otherPortal = 0; otherPortal < amountOfPortals; otherPortal++)
+	{
+		const int32 otherSlot = m_Portals[otherPortal].m_Slot;
+		if (otherSlot == -1 || otherSlot == m_Portals[portal].m_Slot)
+		{
+			continue;
+		}
+
+		// the biggest stitch distance of both networks gets used
+		const AAIPathNetwork* pOtherNetwork = m_Slots[otherSlot].m_pNetwork.Get();
+		const float maxDistance = FMath::Max(stitchDistance, pOtherNetwork->m_PortalStitchDistance);
+		const FVector& location = m_Portals[portal].m_Location;
+		const FVector& otherLocation = m_Portals[otherPortal].m_Location;
+		if (FVector::DistSquared(location, otherLocation) > maxDistance * maxDistance)
+		{
+			continue;
+		}
+
+		// stitch edges use the same cost unit as the paths inside of the network they leave (profile 0, like GetPathData)
+		m_Portals[portal].m_Edges.Add(FPortalEdge{ otherPortal, pNetwork->GetStraightLineCost(location, otherLocation) });
+		m_Portals[otherPortal].m_Edges.Add(FPortalEdge{ portal, pOtherNetwork->GetStraightLineCost(otherLocation, location) });
+
+		InvalidatePortalSearches([otherPortal](const FPortalSearch& search)
+		{
+			return IsValidIndex(otherPortal, search.m_Distances) && search.m_Distances[otherPortal] != FLT_MAX;
+		});
+	}
+}
+
+
+
+/// <summary>
+/// Returns the stored portal search from beginNode, or does a dijkstra over the portal graph and stores it.
+/// The search starts at every portal of the begin network using the distances inside of that network.
+/// </summary>
+/// <param name="slot">Slot of the network beginNode is part of</param>
+/// <param name="beginNode">Node index the search starts from</param>
+/// <returns>Reference to the search stored in m_PortalSearches</returns>
+const UAIPathWorldSubsystem::FPortalSearch& UAIPathWorldSubsystem::GetPortalSearch(int32 slot, int32 beginNode)
+{
+	const uint64 searchKey = MakeSearchKey(slot, beginNode);
+	if (const FPortalSearch* pSearch = m_PortalSearches.Find(searchKey))
+	{
+		return *pSearch;
+	}
+
+	const int32 amountOfPortals = m_Portals.Num();
+	FPortalSearch& search = m_PortalSearches.Add(searchKey);
+	search.m_Distances.Init(FLT_MAX, amountOfPortals);
+	search.m_PreviousPortals.Init(-1, amountOfPortals);
+	search.m_TouchedSlots.Init(false, m_Slots.Num());
+	search.m_TouchedSlots[slot] = true;
+
+	TBitArray<> settled(false, amountOfPortals);
+	TArray<FAIPathOpenEntry> open{};
+
+	const TArray<FAIPathData>& pathData = m_Slots[slot].m_pNetwork->GetPathData(beginNode);
+	for (int32 portal : m_Slots[slot].m_Portals)
+	{
+		const FAIPathData& portalPathData = pathData[m_Portals[portal].m_NodeIndex];
+		if (portalPathData.m_PreviousNodeIndex != -1)
+		{
+			search.m_Distances[portal] = portalPathData.m_Cost;
+			open.HeapPush(FAIPathOpenEntry(portalPathData.m_Cost, portal));
+		}
+	}
+
+	FAIPathOpenEntry current{};
+	while (open.Num() != 0)
+	{
+		open.HeapPop(current, false);
+		if (settled[current.m_Node])
+		{
+			continue;
+		}
+
+		settled[current.m_Node] = true;
+		search.m_TouchedSlots[m_Portals[current.m_Node].m_Slot] = true;
+
+		for (const FPortalEdge& edge : m_Portals[current.m_Node].m_Edges)
+		{
+			const float otherDistance = search.m_Distances[current.m_Node] + edge.m_Weight;
+			if (search.m_Distances[edge.m_Portal] > otherDistance)
+			{
+				search.m_Distances[edge.m_Portal] = otherDistance;
+				search.m_PreviousPortals[edge.m_Portal] = current.m_Node;
+				open.HeapPush(FAIPathOpenEntry(otherDistance, edge.m_Portal));
+			}
+		}
+	}
+
+	return search;
+}
+
+
+
+void UAIPathWorldSubsystem::InvalidatePortalSearches(TFunctionRef<bool(const FPortalSearch&)> shouldRemove)
+{
+	for (auto it = m_PortalSearches.CreateIterator(); it; ++it)
+	{
+		if (shouldRemove(it.Value()))
+		{
+			it.RemoveCurrent();
+		}
+	}
+}
+
+
+
+/// <summary>
+/// Gets the path inside of a single network and appends it to outPath.
+/// </summary>
+/// <returns>If the local path was valid</returns>
+bool UAIPathWorldSubsystem::AppendLocalPath(int32 slot, int32 fromNode, int32 toNode, bool bSkipFirst, FAIPathWorldPath& outPath)
+{
+	AAIPathNetwork* pNetwork = m_Slots[slot].m_pNetwork.Get();
+	const FAIPath localPath = pNetwork->GetPathFromTo(pNetwork->GetPathData(fromNode), toNode);
+	if (!localPath.m_bIsValid)
+	{
+		return false;
+	}
+
+	for (int32 i = bSkipFirst ? 1 : 0; i < localPath.m_Path.Num(); i++)
+	{
+		outPath.m_Path.Add(FAIPathWorldNode(pNetwork, localPath.m_Path[i]));
+	}
+	return true;
+}
+
+
+
+uint64 UAIPathWorldSubsystem::MakeSearchKey(int32 slot, int32 nodeIndex)
+{
+	return (uint64(uint32(slot)) << 32) | uint64(uint32(nodeIndex));
+}
+
+
+
+//
+// AIPathWorldNode
+//
+
+FAIPathWorldNode::FAIPathWorldNode(AAIPathNetwork* pNetwork, int32 nodeIndex)
+	: m_pNetwork{ pNetwork }
+	, m_NodeIndex{ nodeIndex }
+{
+}
+
+
+
+//
+// AIPathWorldPath
+//
+
+FAIPathWorldPath::FAIPathWorldPath()
+{
+}
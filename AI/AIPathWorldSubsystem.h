@@ -0,0 +1,104 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AIPathWorldSubsystem.generated.h"
+
+USTRUCT(BlueprintType)
+struct FAIPathWorldNode
+{
+	GENERATED_BODY()
+
+	FAIPathWorldNode(class AAIPathNetwork* pNetwork = nullptr, int32 nodeIndex = -1);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AIPathNetwork", Meta = (DisplayName = "network"))
+		class AAIPathNetwork* m_pNetwork = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AIPathNetwork", Meta = (DisplayName = "node Index"))
+		int32 m_NodeIndex = -1;
+};
+
+USTRUCT(BlueprintType)
+struct FAIPathWorldPath
+{
+	GENERATED_BODY()
+
+	FAIPathWorldPath();
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AIPathNetwork", Meta = (DisplayName = "valid path"))
+		bool m_bIsValid = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AIPathNetwork", Meta = (DisplayName = "path"))
+		TArray<FAIPathWorldNode> m_Path;
+};
+
+/// <summary>
+/// Connects all AAIPathNetworks in the world (including streamed sublevels) trough their portal nodes.
+/// Only portal nodes are part of the world graph, paths inside a network come from the network itself.
+/// Networks register at BeginPlay and unregister at EndPlay, this only touches the portals of that one network.
+/// </summary>
+UCLASS()
+class SANKARI_API UAIPathWorldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	void RegisterNetwork(class AAIPathNetwork* pNetwork);
+	void UnregisterNetwork(class AAIPathNetwork* pNetwork);
+
+	// not const due to the searches being stored
+	UFUNCTION(BlueprintCallable, Category = "AIPathNetwork")
+		FAIPathWorldPath FindWorldPath(class AAIPathNetwork* pBeginNetwork, int32 beginNode, class AAIPathNetwork* pEndNetwork, int32 endNode);
+
+	UFUNCTION(BlueprintCallable, Category = "AIPathNetwork")
+		FAIPathWorldNode LocationToWorldNode(const FVector& location) const;
+
+private:
+	struct FPortalEdge
+	{
+		int32 m_Portal;
+		float m_Weight;
+	};
+
+	struct FPortal
+	{
+		int32 m_Slot = -1; // -1 means this portal is free to be reused
+		int32 m_NodeIndex = -1;
+		FVector m_Location = FVector::ZeroVector;
+		TArray<FPortalEdge> m_Edges;
+	};
+
+	struct FNetworkSlot
+	{
+		TWeakObjectPtr<class AAIPathNetwork> m_pNetwork;
+		TArray<int32> m_Portals;
+	};
+
+	// all portal distances from one begin node, the portal graph is small so it always gets searched fully
+	struct FPortalSearch
+	{
+		TArray<float> m_Distances;
+		TArray<int32> m_PreviousPortals; // -1 means reached straight from the begin node
+		TBitArray<> m_TouchedSlots;
+	};
+
+	int32 FindSlot(const class AAIPathNetwork* pNetwork) const;
+	int32 AddPortal(int32 slot, int32 nodeIndex, const FVector& location);
+	void StitchPortal(int32 portal, float stitchDistance);
+
+	const FPortalSearch& GetPortalSearch(int32 slot, int32 beginNode);
+	void InvalidatePortalSearches(TFunctionRef<bool(const FPortalSearch&)> shouldRemove);
+
+	// appends the local path in the network of slot, skipping the first node when bSkipFirst
+	bool AppendLocalPath(int32 slot, int32 fromNode, int32 toNode, bool bSkipFirst, FAIPathWorldPath& outPath);
+
+	static uint64 MakeSearchKey(int32 slot, int32 nodeIndex);
+
+	TArray<FNetworkSlot> m_Slots; // slots of unloaded networks get reused
+	TArray<FPortal> m_Portals;
+	TArray<int32> m_FreePortals;
+
+	// <slot + begin node, search>
+	TMap<uint64, FPortalSearch> m_PortalSearches;
+};
@@ -1,4 +1,5 @@
 #include "AbilityBase.h"
+#include "AbilityStats.h"
 
 //
 // AbilityBase
@@ -65,6 +66,11 @@ void AAbilityBase::CastedAbility()
 	check(m_Type == EAbilityType::ACTIVE);
 	m_CanUseAbility = false;
 	m_TimeSinceAbilityUsed = 0.0f;
+
+	if (FAbilityStats::IsEnabled())
+	{
+		FAbilityStats::Get().RecordCast(GetClass());
+	}
 }
 
 
@@ -88,6 +94,13 @@ float AAbilityBase::CooldownPercentage() const
 
 
 
+const FString& AAbilityBase::GetAbilityName() const
+{
+	return m_Name;
+}
+
+
+
 //
 // AbilityInfo
 //
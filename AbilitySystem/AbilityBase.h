@@ -39,6 +39,8 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Ability")
 		float CooldownPercentage() const;
 
+	const FString& GetAbilityName() const;
+
 protected:
 	virtual void BeginPlay() override;
 
@@ -72,4 +74,8 @@ struct FAbilityInfo
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ability Info", Meta = (DisplayName = "AbilityReference"))
 		class AAbilityBase* m_pAbilityRef = nullptr;
+
+	// interned m_Name of the ability when it was registered, NAME_None when there is no ability
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Ability Info", Meta = (DisplayName = "Id"))
+		FName m_Id;
 };
@@ -0,0 +1,307 @@
+#include "AbilityBenchmarkCommandlet.h"
+#include "AbilityBase.h"
+#include "AbilityUserComponent.h"
+#include "AbilityStats.h"
+#include "Components/ChildActorComponent.h"
+#include "Components/SceneComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Math/RandomStream.h"
+#include "Misc/Parse.h"
+#include "Templates/TypeCompatibleBytes.h"
+
+namespace
+{
+	/// <summary>
+	/// Forwards everything to the real allocator and counts the allocations, see InstallAllocationCounter().
+	/// Memory allocated before installing it gets freed trough it, which is fine since it only forwards.
+	/// </summary>
+	class FAllocationCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FAllocationCountingMalloc(FMalloc* pInnerMalloc)
+			: m_pInnerMalloc{ pInnerMalloc }
+		{
+		}
+
+		virtual void* Malloc(SIZE_T count, uint32 alignment) override
+		{
+			m_AmountOfAllocations.IncrementExchange();
+			return m_pInnerMalloc->Malloc(count, alignment);
+		}
+
+		virtual void* Realloc(void* pOriginal, SIZE_T count, uint32 alignment) override
+		{
+			m_AmountOfAllocations.IncrementExchange();
+			return m_pInnerMalloc->Realloc(pOriginal, count, alignment);
+		}
+
+		virtual void Free(void* pOriginal) override
+		{
+			m_pInnerMalloc->Free(pOriginal);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T count, uint32 alignment) override { return m_pInnerMalloc->QuantizeSize(count, alignment); }
+		virtual bool GetAllocationSize(void* pOriginal, SIZE_T& outSize) override { return m_pInnerMalloc->GetAllocationSize(pOriginal, outSize); }
+		virtual void Trim(bool bTrimThreadCaches) override { m_pInnerMalloc->Trim(bTrimThreadCaches); }
+		virtual bool IsInternallyThreadSafe() const override { return m_pInnerMalloc->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return m_pInnerMalloc->ValidateHeap(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& outStats) override { m_pInnerMalloc->GetAllocatorStats(outStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& ar) override { m_pInnerMalloc->DumpAllocatorStats(ar); }
+		virtual void UpdateStats() override { m_pInnerMalloc->UpdateStats(); }
+
+		// threads started after installing have to get the thread caches of the real allocator, otherwise every allocation of them takes the slow path
+		virtual void SetupTLSCachesOnCurrentThread() override { m_pInnerMalloc->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { m_pInnerMalloc->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("AllocationCountingMalloc"); }
+
+		uint64 GetAmountOfAllocations() const { return m_AmountOfAllocations.Load(); }
+
+	private:
+		FMalloc* m_pInnerMalloc;
+		TAtomic<uint64> m_AmountOfAllocations{ 0 };
+	};
+
+	/// <summary>
+	/// Installs the counting allocator as GMalloc the first time it gets called and keeps it for the rest of the process.
+	/// Other threads (task graph, logging, async loading) can read GMalloc at any time, so it never gets uninstalled or destroyed.
+	/// Measure allocations as the difference of GetAmountOfAllocations() before and after.
+	/// </summary>
+	FAllocationCountingMalloc& InstallAllocationCounter()
+	{
+		static TTypeCompatibleBytes<FAllocationCountingMalloc> s_Storage;
+		static FAllocationCountingMalloc* s_pMalloc = []()
+		{
+			FAllocationCountingMalloc* pMalloc = new (s_Storage.GetTypedPtr()) FAllocationCountingMalloc{ GMalloc };
+			FPlatformMisc::MemoryBarrier();
+			GMalloc = pMalloc;
+			return pMalloc;
+		}();
+		return *s_pMalloc;
+	}
+
+	double GetPercentile(TArray<double> samples, double percentile)
+	{
+		if (samples.Num() == 0)
+		{
+			return 0.0;
+		}
+
+		samples.Sort();
+		return samples[FMath::Clamp(FMath::FloorToInt(percentile * (samples.Num() - 1)), 0, samples.Num() - 1)];
+	}
+}
+
+//
+// AbilityBenchmarkCommandlet
+//
+
+UAbilityBenchmarkCommandlet::UAbilityBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+
+/// <summary>
+/// Creates a game world, spawns the ability users and runs the frames. Every frame it:
+/// ticks the world (all ability actors), dispatches the casts of this frame trough UAbilityUserComponent::UseAbility
+/// and copies the FAbilityInfo of every ability like a UI would.
+/// The ability stats are enabled during the run and dumped at the end.
+/// </summary>
+/// <param name="Params">The command line, see the class comment for the parameters</param>
+/// <returns>0 on success</returns>
+int32 UAbilityBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32 amountOfUsers = 2000;
+	int32 abilitiesPerUser = 4;
+	int32 amountOfFrames = 600;
+	float castsPerSecond = 0.5f; // per user
+	float deltaTime = 1.0f / 60.0f;
+	FString abilityClassPath{};
+
+	FParse::Value(*Params, TEXT("Users="), amountOfUsers);
+	FParse::Value(*Params, TEXT("AbilitiesPerUser="), abilitiesPerUser);
+	FParse::Value(*Params, TEXT("Frames="), amountOfFrames);
+	FParse::Value(*Params, TEXT("CastsPerSecond="), castsPerSecond);
+	FParse::Value(*Params, TEXT("DeltaTime="), deltaTime);
+	FParse::Value(*Params, TEXT("AbilityClass="), abilityClassPath);
+
+	amountOfUsers = FMath::Max(amountOfUsers, 1);
+	abilitiesPerUser = FMath::Max(abilitiesPerUser, 1);
+	amountOfFrames = FMath::Max(amountOfFrames, 1);
+
+	UClass* pAbilityClass = abilityClassPath.IsEmpty() ? AAbilityBase::StaticClass() : LoadClass<AAbilityBase>(nullptr, *abilityClassPath);
+	if (pAbilityClass == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("UAbilityBenchmarkCommandlet could not load ability class [ %s ]"), *abilityClassPath);
+		return 1;
+	}
+
+	const FAllocationCountingMalloc& allocationCounter = InstallAllocationCounter();
+
+	UWorld* pWorld = UWorld::CreateWorld(EWorldType::Game, false, TEXT("AbilityBenchmark"));
+	FWorldContext& worldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	worldContext.SetCurrentWorld(pWorld);
+	pWorld->InitializeActorsForPlay(FURL());
+	pWorld->BeginPlay();
+
+	// there is no game mode (and game state) to start the match, so begin play gets dispatched directly.
+	// without it the spawned abilities never get BeginPlay, never register their tick function and their cooldowns never count down
+	pWorld->GetWorldSettings()->NotifyBeginPlay();
+	if (!pWorld->HasBegunPlay())
+	{
+		UE_LOG(LogTemp, Error, TEXT("UAbilityBenchmarkCommandlet could not begin play on the benchmark world"));
+		GEngine->DestroyWorldContext(pWorld);
+		pWorld->DestroyWorld(false);
+		return 1;
+	}
+
+	// spawning
+	const int32 amountOfAbilities = amountOfUsers * abilitiesPerUser;
+	TArray<UAbilityUserComponent*> users{};
+	users.Reserve(amountOfUsers);
+
+	const uint64 memoryBeforeSpawn = FPlatformMemory::GetStats().UsedPhysical;
+	const uint64 allocationsBeforeSpawn = allocationCounter.GetAmountOfAllocations();
+	int32 amountNotTicking = 0;
+	for (int32 u = 0; u < amountOfUsers; u++)
+	{
+		AActor* pOwner = pWorld->SpawnActor<AActor>();
+		USceneComponent* pRoot = NewObject<USceneComponent>(pOwner);
+		pOwner->SetRootComponent(pRoot);
+		pRoot->RegisterComponent();
+
+		UAbilityUserComponent* pUser = NewObject<UAbilityUserComponent>(pOwner);
+		pUser->RegisterComponent();
+
+		for (int32 a = 0; a < abilitiesPerUser; a++)
+		{
+			UChildActorComponent* pChildActor = NewObject<UChildActorComponent>(pOwner);
+			pChildActor->SetChildActorClass(pAbilityClass);
+			pChildActor->SetupAttachment(pRoot);
+			pChildActor->RegisterComponent(); // spawns the ability actor
+			pUser->AddAbility(pChildActor);
+
+			const AActor* pAbility = pChildActor->GetChildActor();
+			amountNotTicking += (pAbility == nullptr || !pAbility->HasActorBegunPlay() || !pAbility->PrimaryActorTick.IsTickFunctionRegistered()) ? 1 : 0;
+		}
+
+		users.Add(pUser);
+	}
+	const uint64 spawnAllocations = allocationCounter.GetAmountOfAllocations() - allocationsBeforeSpawn;
+	const uint64 memoryAfterSpawn = FPlatformMemory::GetStats().UsedPhysical;
+
+	// the world tick timings (and cooldowns, so rejected casts) are meaningless when the abilities do not tick
+	if (amountNotTicking > 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("UAbilityBenchmarkCommandlet [ %d ] of [ %d ] abilities did not begin play or register their tick function"), amountNotTicking, amountOfAbilities);
+		GEngine->DestroyWorldContext(pWorld);
+		pWorld->DestroyWorld(false);
+		return 1;
+	}
+
+	// running
+	const bool bWereStatsEnabled = FAbilityStats::IsEnabled();
+	IConsoleManager::Get().FindConsoleVariable(TEXT("Sankari.AbilityStats"))->Set(1);
+	FAbilityStats::Get().Reset();
+
+	TArray<double> tickTimes{};
+	TArray<double> dispatchTimes{};
+	TArray<double> infoTimes{};
+	TArray<double> frameAllocations{};
+	tickTimes.Reserve(amountOfFrames);
+	dispatchTimes.Reserve(amountOfFrames);
+	infoTimes.Reserve(amountOfFrames);
+	frameAllocations.Reserve(amountOfFrames);
+
+	FRandomStream random{ 12345 }; // fixed seed so runs can be compared
+	float castsToDispatch = 0.0f;
+	int32 amountOfCasts = 0;
+
+	for (int32 frame = 0; frame < amountOfFrames; frame++)
+	{
+		const uint64 allocationsBeforeFrame = allocationCounter.GetAmountOfAllocations();
+
+		double begin = FPlatformTime::Seconds();
+		pWorld->Tick(LEVELTICK_All, deltaTime);
+		tickTimes.Add(FPlatformTime::Seconds() - begin);
+
+		castsToDispatch += castsPerSecond * amountOfUsers * deltaTime;
+		const int32 castsThisFrame = FMath::FloorToInt(castsToDispatch);
+		castsToDispatch -= castsThisFrame;
+		amountOfCasts += castsThisFrame;
+
+		begin = FPlatformTime::Seconds();
+		for (int32 c = 0; c < castsThisFrame; c++)
+		{
+			users[random.RandHelper(amountOfUsers)]->UseAbility(random.RandHelper(abilitiesPerUser));
+		}
+		dispatchTimes.Add(FPlatformTime::Seconds() - begin);
+
+		begin = FPlatformTime::Seconds();
+		int32 amountCastable = 0; // keeps the copies from being optimized away
+		for (const UAbilityUserComponent* pUser : users)
+		{
+			for (int32 a = 0; a < abilitiesPerUser; a++)
+			{
+				const FAbilityInfo abilityInfo = pUser->GetAbilityInfo(a);
+				amountCastable += (abilityInfo.m_pAbilityRef != nullptr && abilityInfo.m_pAbilityRef->CanCastAbility()) ? 1 : 0;
+			}
+		}
+		infoTimes.Add(FPlatformTime::Seconds() - begin);
+		(void)amountCastable;
+
+		frameAllocations.Add(double(allocationCounter.GetAmountOfAllocations() - allocationsBeforeFrame));
+	}
+
+	// report
+	auto logTimes = [](const TCHAR* pName, const TArray<double>& samples)
+	{
+		double sum = 0.0;
+		for (double sample : samples)
+		{
+			sum += sample;
+		}
+		UE_LOG(LogTemp, Display, TEXT("  %-14s average [ %.3f ms ] median [ %.3f ms ] p99 [ %.3f ms ] max [ %.3f ms ]"), pName,
+			sum * 1000.0 / samples.Num(), GetPercentile(samples, 0.5) * 1000.0, GetPercentile(samples, 0.99) * 1000.0, GetPercentile(samples, 1.0) * 1000.0);
+	};
+
+	TArray<double> frameTimes{};
+	frameTimes.SetNumUninitialized(amountOfFrames);
+	for (int32 frame = 0; frame < amountOfFrames; frame++)
+	{
+		frameTimes[frame] = tickTimes[frame] + dispatchTimes[frame] + infoTimes[frame];
+	}
+
+	double allocationSum = 0.0;
+	for (double allocations : frameAllocations)
+	{
+		allocationSum += allocations;
+	}
+
+	const int64 spawnMemory = int64(memoryAfterSpawn) - int64(memoryBeforeSpawn);
+	UE_LOG(LogTemp, Display, TEXT("UAbilityBenchmarkCommandlet [ %d ] users x [ %d ] abilities of [ %s ], [ %d ] frames of [ %.4f s ], [ %d ] casts"),
+		amountOfUsers, abilitiesPerUser, *pAbilityClass->GetName(), amountOfFrames, deltaTime, amountOfCasts);
+	logTimes(TEXT("frame"), frameTimes);
+	logTimes(TEXT("world tick"), tickTimes);
+	logTimes(TEXT("dispatch"), dispatchTimes);
+	logTimes(TEXT("ability info"), infoTimes);
+	UE_LOG(LogTemp, Display, TEXT("  allocations per frame average [ %.1f ] median [ %.1f ] max [ %.1f ]"),
+		allocationSum / amountOfFrames, GetPercentile(frameAllocations, 0.5), GetPercentile(frameAllocations, 1.0));
+	UE_LOG(LogTemp, Display, TEXT("  spawning : [ %.1f ] allocations and [ %.1f ] bytes (used physical memory) per ability, includes the owners"),
+		double(spawnAllocations) / amountOfAbilities, double(spawnMemory) / amountOfAbilities);
+	FAbilityStats::Get().Dump();
+
+	IConsoleManager::Get().FindConsoleVariable(TEXT("Sankari.AbilityStats"))->Set(bWereStatsEnabled ? 1 : 0);
+
+	GEngine->DestroyWorldContext(pWorld);
+	pWorld->DestroyWorld(false);
+	return 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AbilityBenchmarkCommandlet.generated.h"
+
+/// <summary>
+/// Headless benchmark of the ability system, spawns many ability users and drives casts at a fixed rate.
+/// Reports the time per frame (world tick, UseAbility dispatch, GetAbilityInfo copies), allocations and memory per ability.
+/// usage : UE4Editor-Cmd.exe Project.uproject -run=AbilityBenchmark -Users=2000 -AbilitiesPerUser=4 -Frames=600
+///         -CastsPerSecond=0.5 -DeltaTime=0.0166 -AbilityClass=/Game/Abilities/BP_Dash.BP_Dash_C
+/// </summary>
+UCLASS()
+class SANKARI_API UAbilityBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAbilityBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,105 @@
+#include "AbilityStats.h"
+#include "HAL/IConsoleManager.h"
+
+static int32 GAbilityStatsEnabled = 0;
+
+static FAutoConsoleVariableRef CVarAbilityStats(
+	TEXT("Sankari.AbilityStats"),
+	GAbilityStatsEnabled,
+	TEXT("1 counts casts, rejected casts and blueprint dispatch time per ability class, 0 disables it (default)."));
+
+static FAutoConsoleCommand CmdAbilityStatsDump(
+	TEXT("Sankari.AbilityStats.Dump"),
+	TEXT("Writes the ability counters to the output log."),
+	FConsoleCommandDelegate::CreateLambda([]() { FAbilityStats::Get().Dump(); }));
+
+static FAutoConsoleCommand CmdAbilityStatsReset(
+	TEXT("Sankari.AbilityStats.Reset"),
+	TEXT("Clears the ability counters."),
+	FConsoleCommandDelegate::CreateLambda([]() { FAbilityStats::Get().Reset(); }));
+
+//
+// AbilityStats
+//
+
+FAbilityStats& FAbilityStats::Get()
+{
+	static FAbilityStats s_Instance{};
+	return s_Instance;
+}
+
+
+
+bool FAbilityStats::IsEnabled()
+{
+	return GAbilityStatsEnabled != 0;
+}
+
+
+
+void FAbilityStats::RecordCast(const UClass* pAbilityClass)
+{
+	FindOrAddClassStats(pAbilityClass).m_AmountOfCasts++;
+}
+
+
+
+void FAbilityStats::RecordRejectedCast(const UClass* pAbilityClass)
+{
+	FindOrAddClassStats(pAbilityClass).m_AmountOfRejectedCasts++;
+}
+
+
+
+void FAbilityStats::RecordDispatch(const UClass* pAbilityClass, double seconds)
+{
+	FAbilityClassStats& classStats = FindOrAddClassStats(pAbilityClass);
+	classStats.m_AmountOfDispatches++;
+	classStats.m_DispatchSeconds += seconds;
+}
+
+
+
+const TMap<FName, FAbilityClassStats>& FAbilityStats::GetClassStats() const
+{
+	return m_ClassStats;
+}
+
+
+
+/// <summary>
+/// Writes one line per ability class to the output log, the classes that took the most dispatch time first.
+/// Always logs (also without DEBUG_UE_LOG), it only runs when asked for trough the console command or the benchmark.
+/// </summary>
+void FAbilityStats::Dump() const
+{
+	TArray<TPair<FName, FAbilityClassStats>> sortedStats{};
+	for (const TPair<FName, FAbilityClassStats>& classStats : m_ClassStats)
+	{
+		sortedStats.Add(classStats);
+	}
+	sortedStats.Sort([](const TPair<FName, FAbilityClassStats>& a, const TPair<FName, FAbilityClassStats>& b) { return a.Value.m_DispatchSeconds > b.Value.m_DispatchSeconds; });
+
+	UE_LOG(LogTemp, Display, TEXT("FAbilityStats [ %d ] ability classes%s"), sortedStats.Num(), IsEnabled() ? TEXT("") : TEXT(" (Sankari.AbilityStats is disabled)"));
+	for (const TPair<FName, FAbilityClassStats>& classStats : sortedStats)
+	{
+		const FAbilityClassStats& stats = classStats.Value;
+		const double averageMicroseconds = (stats.m_AmountOfDispatches > 0) ? stats.m_DispatchSeconds * 1000000.0 / stats.m_AmountOfDispatches : 0.0;
+		UE_LOG(LogTemp, Display, TEXT("  %s : casts [ %lld ] rejected [ %lld ] dispatches [ %lld ] dispatch total [ %.3f ms ] average [ %.3f us ]"),
+			*classStats.Key.ToString(), stats.m_AmountOfCasts, stats.m_AmountOfRejectedCasts, stats.m_AmountOfDispatches, stats.m_DispatchSeconds * 1000.0, averageMicroseconds);
+	}
+}
+
+
+
+void FAbilityStats::Reset()
+{
+	m_ClassStats.Empty();
+}
+
+
+
+FAbilityClassStats& FAbilityStats::FindOrAddClassStats(const UClass* pAbilityClass)
+{
+	return m_ClassStats.FindOrAdd((pAbilityClass != nullptr) ? pAbilityClass->GetFName() : NAME_None);
+}
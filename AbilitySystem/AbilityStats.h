@@ -0,0 +1,40 @@
+#pragma once
+#include "CoreMinimal.h"
+
+// counters of a single ability class, see FAbilityStats
+struct FAbilityClassStats
+{
+	int64 m_AmountOfCasts = 0;			// AAbilityBase::CastedAbility calls
+	int64 m_AmountOfRejectedCasts = 0;	// UseAbility calls while the ability could not be casted (on cooldown)
+	int64 m_AmountOfDispatches = 0;		// UseAbility events sent to the blueprint
+	double m_DispatchSeconds = 0.0;		// total time spent inside those events
+};
+
+/// <summary>
+/// Opt-in counters per ability class, enabled with the console variable "Sankari.AbilityStats 1".
+/// "Sankari.AbilityStats.Dump" writes them to the output log and "Sankari.AbilityStats.Reset" clears them.
+/// Only used from the game thread, so there is no locking.
+/// </summary>
+class FAbilityStats
+{
+public:
+	static FAbilityStats& Get();
+
+	// callers check this first so nothing gets timed or looked up when the counters are disabled
+	static bool IsEnabled();
+
+	void RecordCast(const UClass* pAbilityClass);
+	void RecordRejectedCast(const UClass* pAbilityClass);
+	void RecordDispatch(const UClass* pAbilityClass, double seconds);
+
+	const TMap<FName, FAbilityClassStats>& GetClassStats() const;
+
+	void Dump() const;
+	void Reset();
+
+private:
+	FAbilityClassStats& FindOrAddClassStats(const UClass* pAbilityClass);
+
+	// <ability class name, counters>, the name instead of the class so recompiled blueprints dont leave dangling keys
+	TMap<FName, FAbilityClassStats> m_ClassStats;
+};
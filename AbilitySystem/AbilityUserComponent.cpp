@@ -1,4 +1,5 @@
 #include "AbilityUserComponent.h"
+#include "AbilityStats.h"
 #include "../Helpers.h"
 
 //
@@ -37,7 +38,10 @@ void UAbilityUserComponent::AddAbility(UChildActorComponent* abilityToAdd, UText
 	newAbilityInfo.m_pAbilityRef = newAbility;
 	newAbilityInfo.m_pUIIcon = abilityUIIcon;
 
+	newAbilityInfo.m_Id = MakeAbilityId(newAbility);
+
 	m_KnownAbilities.Add(newAbilityInfo);
+	RebuildAbilityLookup();
 }
 
 
@@ -51,10 +55,63 @@ void UAbilityUserComponent::SetAbilityAtIndex(int32 index, FAbilityInfo newAbili
 {
 	if (!IsValidIndex(index, m_KnownAbilities))
 	{
-		return LogText(ELogVerbosity::Warning, "UAbilityUserComponent::SetAbilityAtIndex tried to set new ability at invalid index[ " + FString::FromInt(index) + " ]");
+		LOG_TEXT(Warning, TEXT("UAbilityUserComponent::SetAbilityAtIndex tried to set new ability at invalid index[ %d ]"), index);
+		return;
 	}
 
+	// always derived from the ability itself, a copied FAbilityInfo can still carry the id of the ability it was copied from
+	newAbility.m_Id = MakeAbilityId(newAbility.m_pAbilityRef);
+
 	m_KnownAbilities[index] = newAbility;
+	RebuildAbilityLookup();
+}
+
+
+
+/// <summary>
+/// Interns the name of the ability, the only string work, after this the ability is looked up by id.
+/// </summary>
+/// <param name="pAbility">The ability (can be nullptr)</param>
+/// <returns>The id of the ability, NAME_None when there is no ability or it has no name</returns>
+FName UAbilityUserComponent::MakeAbilityId(const AAbilityBase* pAbility)
+{
+	return (pAbility != nullptr && !pAbility->GetAbilityName().IsEmpty()) ? FName(*pAbility->GetAbilityName()) : NAME_None;
+}
+
+
+
+/// <summary>
+/// Fills m_AbilityLookup with every ability that has an id, when ids are duplicate the ability with the lowest index is found.
+/// </summary>
+void UAbilityUserComponent::RebuildAbilityLookup()
+{
+	const int32 tableSize = FMath::RoundUpToPowerOfTwo(FMath::Max(m_KnownAbilities.Num() * 2, 4));
+	m_AbilityLookup.Reset();
+	m_AbilityLookup.SetNum(tableSize);
+
+	for (int32 i = 0; i < m_KnownAbilities.Num(); i++)
+	{
+		const FName id = m_KnownAbilities[i].m_Id;
+		if (id.IsNone())
+		{
+			continue;
+		}
+
+		uint32 slot = GetTypeHash(id) & (tableSize - 1);
+		while (m_AbilityLookup[slot].m_Index != -1 && m_AbilityLookup[slot].m_Id != id)
+		{
+			slot = (slot + 1) & (tableSize - 1);
+		}
+
+		if (m_AbilityLookup[slot].m_Index != -1)
+		{
+			LOG_TEXT(Warning, TEXT("UAbilityUserComponent::RebuildAbilityLookup duplicate ability id [ %s ] at index [ %d ]"), *id.ToString(), i);
+			continue;
+		}
+
+		m_AbilityLookup[slot].m_Id = id;
+		m_AbilityLookup[slot].m_Index = i;
+	}
 }
 
 
@@ -90,11 +147,28 @@ void UAbilityUserComponent::UseAbility(int32 index)
 {
 	if (!AbilityPreCheck(index))
 	{
-		return LogText(ELogVerbosity::Warning, "UAbilityUserComponent::UseAbility preCheck failed!");
+		LOG_TEXT(Warning, TEXT("UAbilityUserComponent::UseAbility preCheck failed!"));
+		return;
 	}
 
 	ensure(this->GetOwner() != nullptr); // the component is assumed to always have an owning actor!
-	m_KnownAbilities[index].m_pAbilityRef->UseAbility(this->GetOwner());
+	AAbilityBase* pAbility = m_KnownAbilities[index].m_pAbilityRef;
+
+	if (!FAbilityStats::IsEnabled())
+	{
+		pAbility->UseAbility(this->GetOwner());
+		return;
+	}
+
+	// the blueprint decides itself what to do on cooldown, so it still gets dispatched
+	if (!pAbility->CanCastAbility())
+	{
+		FAbilityStats::Get().RecordRejectedCast(pAbility->GetClass());
+	}
+
+	const double dispatchBegin = FPlatformTime::Seconds();
+	pAbility->UseAbility(this->GetOwner());
+	FAbilityStats::Get().RecordDispatch(pAbility->GetClass(), FPlatformTime::Seconds() - dispatchBegin);
 }
 
 
@@ -104,3 +178,64 @@ FAbilityInfo UAbilityUserComponent::GetAbilityInfo(int32 index) const
 	return (AbilityPreCheck(index)) ? m_KnownAbilities[index] : FAbilityInfo();
 }
 
+
+
+bool UAbilityUserComponent::CanCastAbility(int32 index) const
+{
+	return AbilityPreCheck(index) && m_KnownAbilities[index].m_pAbilityRef->CanCastAbility();
+}
+
+
+
+void UAbilityUserComponent::UseAbilityById(FName abilityId)
+{
+	const int32 index = FindAbilityIndex(abilityId);
+	if (index == -1)
+	{
+		LOG_TEXT(Warning, TEXT("UAbilityUserComponent::UseAbilityById unknown ability id [ %s ]"), *abilityId.ToString());
+		return;
+	}
+
+	UseAbility(index);
+}
+
+
+
+FAbilityInfo UAbilityUserComponent::GetAbilityInfoById(FName abilityId) const
+{
+	return GetAbilityInfo(FindAbilityIndex(abilityId));
+}
+
+
+
+bool UAbilityUserComponent::CanCastAbilityById(FName abilityId) const
+{
+	return CanCastAbility(FindAbilityIndex(abilityId));
+}
+
+
+
+/// <summary>
+/// Looks up the ability index in m_AbilityLookup, the table is never full so the probing always ends at an empty slot.
+/// FName compares are integer compares, no string work happens here.
+/// </summary>
+/// <param name="abilityId">Id of the ability (its name)</param>
+/// <returns>Index in m_KnownAbilities, -1 when there is no ability with this id</returns>
+int32 UAbilityUserComponent::FindAbilityIndex(FName abilityId) const
+{
+	if (abilityId.IsNone() || m_AbilityLookup.Num() == 0)
+	{
+		return -1;
+	}
+
+	const uint32 mask = m_AbilityLookup.Num() - 1;
+	for (uint32 slot = GetTypeHash(abilityId) & mask; m_AbilityLookup[slot].m_Index != -1; slot = (slot + 1) & mask)
+	{
+		if (m_AbilityLookup[slot].m_Id == abilityId)
+		{
+			return m_AbilityLookup[slot].m_Index;
+		}
+	}
+	return -1;
+}
+
@@ -21,6 +21,23 @@ public:
 
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Abilities")
 		FAbilityInfo GetAbilityInfo(int32 index) const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Abilities")
+		bool CanCastAbility(int32 index) const;
+
+	// by id versions, the id is the name of the ability interned when it was added (O(1), no string compares)
+	UFUNCTION(BlueprintCallable, Category = "Abilities")
+		void UseAbilityById(FName abilityId);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Abilities")
+		FAbilityInfo GetAbilityInfoById(FName abilityId) const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Abilities")
+		bool CanCastAbilityById(FName abilityId) const;
+
+	// index of the ability with the given id, -1 when unknown
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Abilities")
+		int32 FindAbilityIndex(FName abilityId) const;
 	
 	void SetAbilityAtIndex(int32 index, FAbilityInfo newAbility);
 
@@ -28,6 +45,19 @@ protected:
 	virtual void BeginPlay() override;
 
 private:
+	struct FAbilityLookupEntry
+	{
+		FName m_Id;
+		int32 m_Index = -1; // -1 means empty slot
+	};
+
 	bool AbilityPreCheck(uint32 index) const;
+	void RebuildAbilityLookup();
+	static FName MakeAbilityId(const AAbilityBase* pAbility);
+
 	TArray<FAbilityInfo> m_KnownAbilities;
+
+	// open addressing (linear probing) hash table from ability id to index in m_KnownAbilities
+	// size is a power of 2 and at least twice the amount of abilities, rebuilt whenever an ability is added or replaced
+	TArray<FAbilityLookupEntry> m_AbilityLookup;
 };
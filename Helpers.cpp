@@ -1,4 +1,6 @@
 #include "Helpers.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DelayedAutoRegister.h"
 
 void LogText(ELogVerbosity::Type logLevel, const FString& text)
 {
@@ -34,4 +36,88 @@ void LogText(ELogVerbosity::Type logLevel, const FString& text)
 	}
 
 #endif
-}
\ No newline at end of file
+}
+
+
+//
+// LogRingBuffer
+//
+
+#ifdef DEBUG_UE_LOG
+// flush at the end of every engine frame so ring messages get written out regardless of which actors exist in the level
+static FDelayedAutoRegisterHelper GLogRingFlushRegistration(EDelayedRegisterRunPhase::EndOfEngineInit, []()
+{
+	FCoreDelegates::OnEndFrame.AddStatic(&FlushLogRing);
+});
+#endif
+
+FLogRingBuffer& FLogRingBuffer::Get()
+{
+	static FLogRingBuffer s_Instance{};
+	return s_Instance;
+}
+
+
+
+/// <summary>
+/// Claims the next slot in the ring buffer and copies the message into it.
+/// The slot sequence is set to 0 while writing so the flushing side never outputs half written text.
+/// </summary>
+/// <param name="logLevel">Verbosity the message gets flushed at</param>
+/// <param name="text">Already formatted message</param>
+void FLogRingBuffer::Push(ELogVerbosity::Type logLevel, const TCHAR* text)
+{
+	const uint64 writeIndex = m_WriteIndex.IncrementExchange();
+	FEntry& entry = m_Entries[writeIndex & (SANKARI_LOG_RING_CAPACITY - 1)];
+
+	entry.m_Sequence.Store(0, EMemoryOrder::SequentiallyConsistent);
+	entry.m_LogLevel = logLevel;
+	FCString::Strncpy(entry.m_Text, text, MessageLength);
+	entry.m_Sequence.Store(writeIndex + 1, EMemoryOrder::SequentiallyConsistent);
+}
+
+
+
+/// <summary>
+/// Outputs all messages pushed since the last flush.
+/// Messages that got overwritten before flushing are skipped and reported as a single warning.
+/// </summary>
+void FLogRingBuffer::Flush()
+{
+	const uint64 writeIndex = m_WriteIndex.Load();
+
+	if (writeIndex - m_ReadIndex > SANKARI_LOG_RING_CAPACITY)
+	{
+		LOG_TEXT(Warning, TEXT("FLogRingBuffer::Flush dropped [ %llu ] messages"), writeIndex - m_ReadIndex - SANKARI_LOG_RING_CAPACITY);
+		m_ReadIndex = writeIndex - SANKARI_LOG_RING_CAPACITY;
+	}
+
+	TCHAR text[MessageLength];
+	for (; m_ReadIndex < writeIndex; m_ReadIndex++)
+	{
+		const FEntry& entry = m_Entries[m_ReadIndex & (SANKARI_LOG_RING_CAPACITY - 1)];
+		const uint64 sequence = entry.m_Sequence.Load();
+
+		// 0 while being written, the sequence of an older lap when the writer claimed the slot but did not start writing yet
+		if (sequence < m_ReadIndex + 1)
+		{
+			break; // not published yet, try again next flush
+		}
+
+		if (sequence > m_ReadIndex + 1)
+		{
+			continue; // already overwritten by a newer message
+		}
+
+		const ELogVerbosity::Type logLevel = entry.m_LogLevel;
+		FCString::Strncpy(text, entry.m_Text, MessageLength);
+
+		// got overwritten while copying
+		if (entry.m_Sequence.Load() != sequence)
+		{
+			continue;
+		}
+
+		LogText(logLevel, text);
+	}
+}
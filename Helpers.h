@@ -2,8 +2,90 @@
 #include "CoreMinimal.h"
 #include "Logging/LogVerbosity.h"
 
+// Anything more verbose than this level gets compiled out of the LOG_TEXT / LOG_TEXT_RING macros.
+// Can be overwritten per module (Build.cs PublicDefinitions) to for example strip Verbose logging.
+#ifndef SANKARI_LOG_COMPILETIME_VERBOSITY
+#define SANKARI_LOG_COMPILETIME_VERBOSITY ELogVerbosity::Log
+#endif
+
+// Capacity of the ring buffer log sink, has to be a power of 2
+#ifndef SANKARI_LOG_RING_CAPACITY
+#define SANKARI_LOG_RING_CAPACITY 1024
+#endif
+
 void LogText(ELogVerbosity::Type logLevel, const FString& text);
 
+/// <summary>
+/// Lock free ring buffer for high frequency diagnostics (once per query, once per frame per agent, ...).
+/// Any thread can push messages, the game thread flushes them to the output log with FlushLogRing().
+/// When producers are faster than the flushing the oldest messages get overwritten.
+/// </summary>
+class FLogRingBuffer
+{
+public:
+	static constexpr int32 MessageLength = 128;
+
+	static FLogRingBuffer& Get();
+
+	// formatting already happened at this point, the message gets truncated to MessageLength
+	void Push(ELogVerbosity::Type logLevel, const TCHAR* text);
+
+	// writes all pending messages to the output log, should only be called from one thread at a time
+	void Flush();
+
+private:
+	static_assert((SANKARI_LOG_RING_CAPACITY & (SANKARI_LOG_RING_CAPACITY - 1)) == 0, "SANKARI_LOG_RING_CAPACITY has to be a power of 2");
+
+	struct FEntry
+	{
+		// sequence number of the write that filled this slot (+1), 0 means never written
+		TAtomic<uint64> m_Sequence{ 0 };
+		ELogVerbosity::Type m_LogLevel = ELogVerbosity::Log;
+		TCHAR m_Text[MessageLength];
+	};
+
+	FEntry m_Entries[SANKARI_LOG_RING_CAPACITY];
+	TAtomic<uint64> m_WriteIndex{ 0 };
+	uint64 m_ReadIndex = 0;
+};
+
+// Flushed once per frame from FCoreDelegates::OnEndFrame (registered in Helpers.cpp), can be called manually as well
+inline void FlushLogRing()
+{
+#ifdef DEBUG_UE_LOG
+	FLogRingBuffer::Get().Flush();
+#endif
+}
+
+// Logs to LogTemp only when DEBUG_UE_LOG is defined and the verbosity passes the compile time filter.
+// UE_LOG checks the runtime verbosity before formatting, so filtered lines never format or allocate.
+// usage : LOG_TEXT(Warning, TEXT("cannot reach targetNode [ %d ]"), toNode);
+#ifdef DEBUG_UE_LOG
+#define LOG_TEXT(verbosity, format, ...) \
+	do \
+	{ \
+		if (ELogVerbosity::verbosity <= SANKARI_LOG_COMPILETIME_VERBOSITY) \
+		{ \
+			UE_LOG(LogTemp, verbosity, format, ##__VA_ARGS__); \
+		} \
+	} while (false)
+
+// same as LOG_TEXT but formats into FLogRingBuffer instead of directly writing to the output log
+#define LOG_TEXT_RING(verbosity, format, ...) \
+	do \
+	{ \
+		if (ELogVerbosity::verbosity <= SANKARI_LOG_COMPILETIME_VERBOSITY && !LogTemp.IsSuppressed(ELogVerbosity::verbosity)) \
+		{ \
+			TCHAR logRingMessage[FLogRingBuffer::MessageLength]; \
+			FCString::Snprintf(logRingMessage, FLogRingBuffer::MessageLength, format, ##__VA_ARGS__); \
+			FLogRingBuffer::Get().Push(ELogVerbosity::verbosity, logRingMessage); \
+		} \
+	} while (false)
+#else
+#define LOG_TEXT(verbosity, format, ...) do {} while (false)
+#define LOG_TEXT_RING(verbosity, format, ...) do {} while (false)
+#endif // DEBUG_UE_LOG
+
 template<typename T>
 bool IsValidIndex(int index, const TArray<T>& arr)
 {